@@ -5,6 +5,24 @@
 #include <algorithm>
 #include <iterator>
 
+// Способ освобождения массива: по умолчанию delete[], иначе
+// function(data, context) — для буферов, выделенных кодеками, C-библиотеками
+// или malloc.
+template <typename Type>
+struct ArrayDeleter {
+    void (*function)(Type* data, void* context) = nullptr;
+    void* context = nullptr;
+
+    void operator()(Type* data) const noexcept {
+        if (function != nullptr) {
+            function(data, context);
+        }
+        else {
+            delete[] data;
+        }
+    }
+};
+
 template <typename Type>
 class ArrayPtr {
 public:
@@ -23,21 +41,26 @@ public:
         raw_ptr_ = raw_ptr;
     }
 
-    ArrayPtr(ArrayPtr&& other) : raw_ptr_(std::move(other.raw_ptr_)) {
+    ArrayPtr(Type* raw_ptr, ArrayDeleter<Type> deleter) noexcept : raw_ptr_(raw_ptr), deleter_(deleter) {
+    }
+
+    ArrayPtr(ArrayPtr&& other) : raw_ptr_(std::move(other.raw_ptr_)), deleter_(other.deleter_) {
         other.raw_ptr_ = nullptr;
     }
 
     ArrayPtr(const ArrayPtr&) = delete;
 
     ~ArrayPtr() {
-        delete[] raw_ptr_;
+        if (raw_ptr_ != nullptr) {
+            deleter_(raw_ptr_);
+        }
     }
 
     ArrayPtr& operator=(const ArrayPtr&) = delete;
 
     ArrayPtr& operator=(ArrayPtr&& rhs) {
         if (this != &rhs) {
-            std::swap(raw_ptr_, rhs.raw_ptr_);
+            swap(rhs);
         }
         return *this;
     }
@@ -64,10 +87,16 @@ public:
         return raw_ptr_;
     }
 
+    const ArrayDeleter<Type>& GetDeleter() const noexcept {
+        return deleter_;
+    }
+
     void swap(ArrayPtr& other) noexcept {
         std::swap(raw_ptr_, other.raw_ptr_);
+        std::swap(deleter_, other.deleter_);
     }
 
 private:
     Type* raw_ptr_ = nullptr;
+    ArrayDeleter<Type> deleter_;
 };
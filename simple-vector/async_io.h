@@ -0,0 +1,630 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define SIMPLE_VECTOR_HAS_IO_URING 1
+#endif
+
+#include "parallel.h"
+#include "serialization.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+enum class AsyncIoBackend {
+    Auto,
+    IoUring,
+    ThreadPool,
+};
+
+// Вызывается по завершении операции; nullptr — успех.
+using IoCallback = std::function<void(std::exception_ptr error)>;
+
+namespace async_io_detail {
+
+// Чтение или запись буферов целиком по смещению; после частичного
+// выполнения продолжается с оставшихся байт.
+struct Operation {
+    bool write = false;
+    int fd = -1;
+    uint64_t offset = 0;
+    iovec buffers[3] = {};
+    int buffer_count = 0;
+    IoCallback callback;
+    // Данные, которые должны жить до завершения (например, заголовок).
+    std::shared_ptr<void> payload;
+
+    bool IsDone() const noexcept {
+        return buffer_count == 0;
+    }
+
+    void Advance(size_t bytes) noexcept {
+        offset += bytes;
+        size_t first = 0;
+        while (first < static_cast<size_t>(buffer_count) && bytes >= buffers[first].iov_len) {
+            bytes -= buffers[first].iov_len;
+            ++first;
+        }
+        std::move(buffers + first, buffers + buffer_count, buffers);
+        buffer_count -= static_cast<int>(first);
+        if (buffer_count > 0) {
+            buffers[0].iov_base = static_cast<char*>(buffers[0].iov_base) + bytes;
+            buffers[0].iov_len -= bytes;
+        }
+    }
+};
+
+inline std::exception_ptr MakeError(int error, const char* what) {
+    return std::make_exception_ptr(std::system_error(error, std::generic_category(), what));
+}
+
+inline std::exception_ptr MakeEndOfFileError() {
+    using namespace std::string_literals;
+    return std::make_exception_ptr(std::runtime_error("Unexpected end of vector file"s));
+}
+
+// Разбор результата одного системного вызова: nullptr и IsDone() — готово,
+// nullptr и !IsDone() — нужно продолжить.
+inline std::exception_ptr ApplyResult(Operation& operation, ssize_t result) {
+    if (result < 0) {
+        return MakeError(static_cast<int>(-result), operation.write ? "pwritev" : "preadv");
+    }
+    if (result == 0) {
+        return MakeEndOfFileError();
+    }
+    operation.Advance(static_cast<size_t>(result));
+    return nullptr;
+}
+
+class Backend {
+public:
+    using Completion = std::function<void(Operation*, std::exception_ptr)>;
+
+    virtual ~Backend() = default;
+
+    virtual void Submit(Operation* operation) = 0;
+};
+
+// Запасной вариант: блокирующие preadv/pwritev на пуле потоков.
+class ThreadPoolBackend : public Backend {
+public:
+    ThreadPoolBackend(size_t thread_count, Completion completion) : completion_(std::move(completion)) {
+        thread_count = std::max<size_t>(thread_count, 1);
+        workers_.Reserve(thread_count);
+        for (size_t index = 0; index < thread_count; ++index) {
+            workers_.PushBack(std::thread([this]() {
+                Work();
+            }));
+        }
+    }
+
+    ~ThreadPoolBackend() override {
+        {
+            std::lock_guard lock(mutex_);
+            stopped_ = true;
+        }
+        changed_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void Submit(Operation* operation) override {
+        {
+            std::lock_guard lock(mutex_);
+            queue_.push_back(operation);
+        }
+        changed_.notify_one();
+    }
+
+private:
+    void Work() {
+        while (true) {
+            Operation* operation = nullptr;
+            {
+                std::unique_lock lock(mutex_);
+                changed_.wait(lock, [this]() {
+                    return stopped_ || !queue_.empty();
+                });
+                if (queue_.empty()) {
+                    return;
+                }
+                operation = queue_.front();
+                queue_.pop_front();
+            }
+            std::exception_ptr error;
+            while (!error && !operation->IsDone()) {
+                const ssize_t result =
+                    operation->write
+                        ? ::pwritev(operation->fd, operation->buffers, operation->buffer_count,
+                                    static_cast<off_t>(operation->offset))
+                        : ::preadv(operation->fd, operation->buffers, operation->buffer_count,
+                                   static_cast<off_t>(operation->offset));
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+                error = ApplyResult(*operation, result < 0 ? -errno : result);
+            }
+            completion_(operation, error);
+        }
+    }
+
+    Completion completion_;
+    SimpleVector<std::thread> workers_;
+    std::deque<Operation*> queue_;
+    bool stopped_ = false;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+};
+
+#if defined(SIMPLE_VECTOR_HAS_IO_URING)
+
+// io_uring через системные вызовы, без liburing. Отправка — под мьютексом
+// из любого потока, завершения разбирает отдельный поток. Число операций в
+// полёте ограничено очередью отправки, а очередь завершений вдвое больше,
+// поэтому она не переполняется.
+class IoUringBackend : public Backend {
+public:
+    IoUringBackend(size_t queue_depth, Completion completion) : completion_(std::move(completion)) {
+        io_uring_params params{};
+        ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+        if (ring_fd_ < 0) {
+            serialization_detail::ThrowErrno("io_uring_setup");
+        }
+        limit_ = params.sq_entries;
+        try {
+            MapRings(params);
+            reaper_ = std::thread([this]() {
+                Reap();
+            });
+        }
+        catch (...) {
+            Unmap();
+            ::close(ring_fd_);
+            throw;
+        }
+        reaper_id_ = reaper_.get_id();
+    }
+
+    ~IoUringBackend() override {
+        // Пустая операция с нулевым user_data останавливает поток завершений.
+        Push(nullptr);
+        reaper_.join();
+        Unmap();
+        ::close(ring_fd_);
+    }
+
+    void Submit(Operation* operation) override {
+        if (std::this_thread::get_id() != reaper_id_) {
+            std::unique_lock lock(limit_mutex_);
+            limit_changed_.wait(lock, [this]() {
+                return in_flight_ < limit_;
+            });
+            ++in_flight_;
+        }
+        else {
+            // Поток завершений не ждёт: место только что освободила
+            // завершённая операция, запас даёт удвоенная очередь завершений.
+            std::lock_guard lock(limit_mutex_);
+            ++in_flight_;
+        }
+        try {
+            Push(operation);
+        }
+        catch (...) {
+            {
+                std::lock_guard lock(limit_mutex_);
+                --in_flight_;
+            }
+            limit_changed_.notify_one();
+            throw;
+        }
+    }
+
+private:
+    template <typename Value>
+    static Value* At(void* base, uint32_t offset) noexcept {
+        return reinterpret_cast<Value*>(static_cast<char*>(base) + offset);
+    }
+
+    void MapRings(const io_uring_params& params) {
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+        sq_ring_ = MapRegion(sq_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap ? sq_ring_ : MapRegion(cq_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(MapRegion(sqes_size_, IORING_OFF_SQES));
+
+        sq_tail_ = At<uint32_t>(sq_ring_, params.sq_off.tail);
+        sq_mask_ = *At<uint32_t>(sq_ring_, params.sq_off.ring_mask);
+        sq_array_ = At<uint32_t>(sq_ring_, params.sq_off.array);
+        cq_head_ = At<uint32_t>(cq_ring_, params.cq_off.head);
+        cq_tail_ = At<uint32_t>(cq_ring_, params.cq_off.tail);
+        cq_mask_ = *At<uint32_t>(cq_ring_, params.cq_off.ring_mask);
+        cqes_ = At<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+    }
+
+    void* MapRegion(size_t size, off_t offset) {
+        void* region = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+        if (region == MAP_FAILED) {
+            serialization_detail::ThrowErrno("mmap");
+        }
+        return region;
+    }
+
+    void Unmap() noexcept {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_size_);
+        }
+        if (sq_ring_ != nullptr) {
+            ::munmap(sq_ring_, sq_size_);
+        }
+        sqes_ = nullptr;
+        sq_ring_ = cq_ring_ = nullptr;
+    }
+
+    // Ядро забирает запись из очереди отправки ещё внутри io_uring_enter,
+    // поэтому при отправке по одной очередь не переполняется. При ошибке
+    // вызова запись не забрана, и хвост очереди откатывается.
+    void Push(Operation* operation) {
+        std::lock_guard lock(submit_mutex_);
+        const uint32_t tail = *sq_tail_;
+        const uint32_t index = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[index];
+        sqe = io_uring_sqe{};
+        if (operation == nullptr) {
+            sqe.opcode = IORING_OP_NOP;
+        }
+        else {
+            sqe.opcode = operation->write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe.fd = operation->fd;
+            sqe.off = operation->offset;
+            sqe.addr = reinterpret_cast<uint64_t>(operation->buffers);
+            sqe.len = static_cast<uint32_t>(operation->buffer_count);
+            sqe.user_data = reinterpret_cast<uint64_t>(operation);
+        }
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        while (true) {
+            const long submitted = ::syscall(__NR_io_uring_enter, ring_fd_, 1u, 0u, 0u, nullptr, 0);
+            if (submitted >= 0) {
+                break;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                const int error = errno;
+                __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+                throw std::system_error(error, std::generic_category(), "io_uring_enter");
+            }
+        }
+    }
+
+    void Reap() {
+        while (true) {
+            uint32_t head = *cq_head_;
+            const uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            if (head == tail) {
+                ::syscall(__NR_io_uring_enter, ring_fd_, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+            // Порядок «отправка раньше завершения» обеспечивает ядро; захват
+            // мьютекса отправки делает его видимым и для модели памяти C++.
+            {
+                std::lock_guard lock(submit_mutex_);
+            }
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                auto* operation = reinterpret_cast<Operation*>(cqe.user_data);
+                const int result = cqe.res;
+                __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+                if (operation == nullptr) {
+                    return;
+                }
+                {
+                    std::lock_guard lock(limit_mutex_);
+                    --in_flight_;
+                }
+                limit_changed_.notify_one();
+                Handle(operation, result);
+            }
+        }
+    }
+
+    void Handle(Operation* operation, int result) {
+        std::exception_ptr error;
+        if (result != -EINTR && result != -EAGAIN) {
+            error = ApplyResult(*operation, result);
+            if (error || operation->IsDone()) {
+                completion_(operation, error);
+                return;
+            }
+        }
+        try {
+            Submit(operation);
+        }
+        catch (...) {
+            completion_(operation, std::current_exception());
+        }
+    }
+
+    Completion completion_;
+    int ring_fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    size_t sqes_size_ = 0;
+    uint32_t* sq_tail_ = nullptr;
+    uint32_t sq_mask_ = 0;
+    uint32_t* sq_array_ = nullptr;
+    uint32_t* cq_head_ = nullptr;
+    uint32_t* cq_tail_ = nullptr;
+    uint32_t cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    std::mutex submit_mutex_;
+    std::mutex limit_mutex_;
+    std::condition_variable limit_changed_;
+    size_t in_flight_ = 0;
+    size_t limit_ = 0;
+    std::thread::id reaper_id_;
+    std::thread reaper_;
+};
+
+#endif
+
+}  // namespace async_io_detail
+
+// Асинхронная загрузка и сохранение векторов: много операций отправляются
+// сразу и завершаются обратным вызовом или future. На Linux используется
+// io_uring, при его недоступности — пул потоков с preadv/pwritev.
+// Обратные вызовы выполняются в служебных потоках и не должны долго
+// блокироваться; исключения из них подавляются. Буферы и fd должны жить до завершения операции;
+// деструктор дожидается всех операций.
+class AsyncVectorIo {
+public:
+    explicit AsyncVectorIo(AsyncIoBackend backend = AsyncIoBackend::Auto, size_t queue_depth = 64,
+                           size_t thread_count = DefaultThreadCount()) {
+        auto completion = [this](async_io_detail::Operation* operation, std::exception_ptr error) {
+            Complete(operation, error);
+        };
+#if defined(SIMPLE_VECTOR_HAS_IO_URING)
+        if (backend != AsyncIoBackend::ThreadPool) {
+            try {
+                backend_ = std::make_unique<async_io_detail::IoUringBackend>(queue_depth, completion);
+                kind_ = AsyncIoBackend::IoUring;
+                return;
+            }
+            catch (const std::system_error&) {
+                if (backend == AsyncIoBackend::IoUring) {
+                    throw;
+                }
+            }
+        }
+#else
+        if (backend == AsyncIoBackend::IoUring) {
+            using namespace std::string_literals;
+            throw std::runtime_error("io_uring is not available"s);
+        }
+#endif
+        (void)queue_depth;
+        backend_ = std::make_unique<async_io_detail::ThreadPoolBackend>(thread_count, completion);
+        kind_ = AsyncIoBackend::ThreadPool;
+    }
+
+    AsyncVectorIo(const AsyncVectorIo&) = delete;
+    AsyncVectorIo& operator=(const AsyncVectorIo&) = delete;
+
+    ~AsyncVectorIo() {
+        Wait();
+        backend_.reset();
+    }
+
+    AsyncIoBackend GetBackend() const noexcept {
+        return kind_;
+    }
+
+    // Дожидается завершения всех отправленных операций.
+    void Wait() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this]() {
+            return pending_ == 0;
+        });
+    }
+
+    void ReadAt(int fd, uint64_t offset, void* data, size_t size, IoCallback callback) {
+        auto* operation = new async_io_detail::Operation;
+        operation->fd = fd;
+        operation->offset = offset;
+        operation->buffers[0] = {data, size};
+        operation->buffer_count = size == 0 ? 0 : 1;
+        operation->callback = std::move(callback);
+        Submit(operation);
+    }
+
+    void WriteAt(int fd, uint64_t offset, const void* data, size_t size, IoCallback callback) {
+        auto* operation = new async_io_detail::Operation;
+        operation->write = true;
+        operation->fd = fd;
+        operation->offset = offset;
+        operation->buffers[0] = {const_cast<void*>(data), size};
+        operation->buffer_count = size == 0 ? 0 : 1;
+        operation->callback = std::move(callback);
+        Submit(operation);
+    }
+
+    // Загружает файл формата serialization.h с начала fd в values. Если
+    // ёмкость values заранее зарезервирована, память не выделяется.
+    // Заявленный размер сверяется с длиной файла до изменения values.
+    template <typename Type>
+    void Load(int fd, SimpleVector<Type>& values, IoCallback callback, bool verify_checksum = true) {
+        static_assert(std::is_trivially_copyable_v<Type>, "Load requires a trivially copyable type");
+        auto header = std::make_shared<VectorFileHeader>();
+        ReadAt(fd, 0, header.get(), sizeof(VectorFileHeader),
+               [this, fd, &values, header, callback = std::move(callback), verify_checksum](std::exception_ptr error) {
+                   if (!error) {
+                       try {
+                           serialization_detail::ValidateHeader<Type>(*header);
+                           serialization_detail::CheckFileSize(fd, *header, 0);
+                           values.Resize(header->count);
+                       }
+                       catch (...) {
+                           error = std::current_exception();
+                       }
+                   }
+                   if (error) {
+                       callback(error);
+                       return;
+                   }
+                   ReadAt(fd, header->data_offset, values.begin(), header->count * sizeof(Type),
+                          [&values, header, callback, verify_checksum](std::exception_ptr data_error) {
+                              if (!data_error && verify_checksum) {
+                                  try {
+                                      serialization_detail::VerifyChecksum(*header, values.begin());
+                                  }
+                                  catch (...) {
+                                      data_error = std::current_exception();
+                                  }
+                              }
+                              callback(data_error);
+                          });
+               });
+    }
+
+    template <typename Type>
+    std::future<void> Load(int fd, SimpleVector<Type>& values, bool verify_checksum = true) {
+        auto promise = std::make_shared<std::promise<void>>();
+        std::future<void> result = promise->get_future();
+        Load(fd, values, PromiseCallback(promise), verify_checksum);
+        return result;
+    }
+
+    // Записывает вектор в формате serialization.h с начала fd одной
+    // операцией записи нескольких буферов.
+    template <typename Type>
+    void Store(int fd, SimpleVectorView<Type> values, IoCallback callback) {
+        static_assert(std::is_trivially_copyable_v<Type>, "Store requires a trivially copyable type");
+        static const char padding[serialization_detail::kDataAlignment + alignof(Type)] = {};
+        auto header = std::make_shared<VectorFileHeader>(serialization_detail::MakeHeader(values));
+        auto* operation = new async_io_detail::Operation;
+        operation->write = true;
+        operation->fd = fd;
+        operation->buffers[0] = {header.get(), sizeof(VectorFileHeader)};
+        operation->buffers[1] = {const_cast<char*>(padding), header->data_offset - sizeof(VectorFileHeader)};
+        operation->buffers[2] = {const_cast<Type*>(values.GetData()), values.GetSize() * sizeof(Type)};
+        operation->buffer_count = 3;
+        operation->callback = std::move(callback);
+        operation->payload = std::move(header);
+        Submit(operation);
+    }
+
+    template <typename Type>
+    void Store(int fd, const SimpleVector<Type>& values, IoCallback callback) {
+        Store(fd, SimpleVectorView<Type>(values), std::move(callback));
+    }
+
+    // Запись идёт из буфера вектора уже после возврата, поэтому временный
+    // вектор к тому моменту был бы освобождён.
+    template <typename Type>
+    void Store(int fd, SimpleVector<Type>&& values, IoCallback callback) = delete;
+
+    template <typename Type>
+    std::future<void> Store(int fd, SimpleVectorView<Type> values) {
+        auto promise = std::make_shared<std::promise<void>>();
+        std::future<void> result = promise->get_future();
+        Store(fd, values, PromiseCallback(promise));
+        return result;
+    }
+
+    template <typename Type>
+    std::future<void> Store(int fd, const SimpleVector<Type>& values) {
+        return Store(fd, SimpleVectorView<Type>(values));
+    }
+
+    template <typename Type>
+    std::future<void> Store(int fd, SimpleVector<Type>&& values) = delete;
+
+private:
+    static IoCallback PromiseCallback(std::shared_ptr<std::promise<void>> promise) {
+        return [promise = std::move(promise)](std::exception_ptr error) {
+            if (error) {
+                promise->set_exception(error);
+            }
+            else {
+                promise->set_value();
+            }
+        };
+    }
+
+    void Submit(async_io_detail::Operation* operation) {
+        {
+            std::lock_guard lock(mutex_);
+            ++pending_;
+        }
+        if (operation->IsDone()) {
+            Complete(operation, nullptr);
+            return;
+        }
+        // Ошибка отправки доставляется обратному вызову, как и ошибка
+        // ввода-вывода, иначе операция не завершилась бы и Wait завис.
+        try {
+            backend_->Submit(operation);
+        }
+        catch (...) {
+            Complete(operation, std::current_exception());
+        }
+    }
+
+    // Счётчик уменьшается после обратного вызова: операции, отправленные из
+    // него, учитываются раньше, и Wait не завершается между звеньями цепочки.
+    void Complete(async_io_detail::Operation* operation, std::exception_ptr error) {
+        std::unique_ptr<async_io_detail::Operation> owned(operation);
+        if (owned->callback) {
+            try {
+                owned->callback(error);
+            }
+            catch (...) {
+            }
+        }
+        owned.reset();
+        std::lock_guard lock(mutex_);
+        if (--pending_ == 0) {
+            idle_.notify_all();
+        }
+    }
+
+    std::unique_ptr<async_io_detail::Backend> backend_;
+    AsyncIoBackend kind_ = AsyncIoBackend::ThreadPool;
+    size_t pending_ = 0;
+    std::mutex mutex_;
+    std::condition_variable idle_;
+};
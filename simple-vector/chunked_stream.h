@@ -0,0 +1,514 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "compression.h"
+#include "parallel.h"
+#include "serialization.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+// Потоковый формат для векторов больше памяти: заголовок потока, затем
+// куски по chunk_size элементов (последний может быть короче), каждый со
+// своим заголовком и контрольной суммой. Поток завершает кусок из нуля
+// элементов. Версия 1 — только несжатые куски; сжатые потоки пишутся с
+// версией 2, чтобы старый читатель сообщал о неподдерживаемой версии.
+struct StreamHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianness;
+    uint32_t type_tag;
+    uint32_t element_size;
+    uint64_t chunk_size;
+    uint8_t reserved[32];
+};
+
+struct ChunkHeader {
+    uint32_t magic;
+    // Флаги ChunkCodec, применённые к куску; 0 — данные как есть.
+    uint32_t codec;
+    uint64_t count;
+    uint64_t stored_size;
+    uint64_t checksum;
+};
+
+static_assert(sizeof(StreamHeader) == 64, "StreamHeader must stay 64 bytes");
+static_assert(sizeof(ChunkHeader) == 32, "ChunkHeader must stay 32 bytes");
+
+namespace chunked_stream_detail {
+
+constexpr char kMagic[8] = {'S', 'V', 'S', 'T', 'R', 'E', 'A', 'M'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kCompressedVersion = 2;
+constexpr uint32_t kChunkMagic = 0x4b435653u;
+constexpr size_t kDefaultChunkBytes = size_t{1} << 20;
+// Кусок занимает два iovec, а writev принимает не больше IOV_MAX.
+constexpr size_t kMaxBatchChunks = IOV_MAX / 2;
+
+template <typename Type>
+size_t DefaultChunkSize() noexcept {
+    return std::max<size_t>(1, kDefaultChunkBytes / sizeof(Type));
+}
+
+template <typename Type>
+void WriteStreamHeader(int fd, size_t chunk_size, ChunkCodec codec) {
+    StreamHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.version = codec == ChunkCodec::None ? kVersion : kCompressedVersion;
+    header.endianness = serialization_detail::kEndiannessMark;
+    header.type_tag = VectorTypeTag<Type>::value;
+    header.element_size = sizeof(Type);
+    header.chunk_size = chunk_size;
+    iovec buffer{&header, sizeof(header)};
+    serialization_detail::WriteAll(fd, &buffer, 1);
+}
+
+template <typename Type>
+StreamHeader ReadStreamHeader(int fd) {
+    using namespace std::string_literals;
+    StreamHeader header;
+    serialization_detail::ReadAll(fd, &header, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a vector stream"s);
+    }
+    if (header.version != kVersion && header.version != kCompressedVersion) {
+        throw std::runtime_error("Unsupported vector stream version "s + std::to_string(header.version));
+    }
+    if (header.endianness != serialization_detail::kEndiannessMark) {
+        throw std::runtime_error("Vector stream has foreign byte order"s);
+    }
+    if (header.element_size != sizeof(Type) || header.type_tag != VectorTypeTag<Type>::value) {
+        throw std::runtime_error("Vector stream element type mismatch"s);
+    }
+    if (header.chunk_size == 0) {
+        throw std::runtime_error("Corrupted vector stream header"s);
+    }
+    return header;
+}
+
+// Сжатый кусок хранится, только если он меньше исходного, поэтому размер
+// данных куска не превосходит count * sizeof(Type).
+template <typename Type>
+void ValidateChunkHeader(const ChunkHeader& header, const StreamHeader& stream) {
+    if (header.magic != kChunkMagic || header.count > stream.chunk_size ||
+        (header.codec != 0 && stream.version < kCompressedVersion) ||
+        (header.codec == 0 ? header.stored_size != header.count * sizeof(Type)
+                           : header.stored_size >= header.count * sizeof(Type))) {
+        using namespace std::string_literals;
+        throw std::runtime_error("Corrupted vector stream chunk"s);
+    }
+}
+
+template <typename Type>
+ChunkHeader ReadChunkHeader(int fd, const StreamHeader& stream) {
+    ChunkHeader header;
+    serialization_detail::ReadAll(fd, &header, sizeof(header));
+    ValidateChunkHeader<Type>(header, stream);
+    return header;
+}
+
+// Как serialization_detail::ReadAll, но перед каждым read ждёт данных в fd
+// или сигнала в stop_fd; по сигналу бросает исключение. Так чтение из
+// канала или сокета, где данные могут не прийти, можно прервать.
+inline void ReadAllOrStop(int fd, int stop_fd, void* data, size_t size) {
+    using namespace std::string_literals;
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        pollfd fds[2] = {{fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            serialization_detail::ThrowErrno("poll");
+        }
+        if (fds[1].revents != 0) {
+            throw std::runtime_error("Vector stream reading stopped"s);
+        }
+        const ssize_t done = ::read(fd, bytes, size);
+        if (done < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            serialization_detail::ThrowErrno("read");
+        }
+        if (done == 0) {
+            throw std::runtime_error("Unexpected end of vector file"s);
+        }
+        bytes += done;
+        size -= static_cast<size_t>(done);
+    }
+}
+
+inline void VerifyChunk(const ChunkHeader& header, const void* data, bool verify_checksum) {
+    if (verify_checksum && serialization_detail::Checksum(data, header.stored_size) != header.checksum) {
+        using namespace std::string_literals;
+        throw std::runtime_error("Vector stream checksum mismatch"s);
+    }
+}
+
+// Заполняет заголовок куска и буферы для записи: сжатые данные из encoded
+// или исходные элементы, если сжатие не помогло или не запрошено.
+template <typename Type>
+void PrepareChunk(SimpleVectorView<Type> values, ChunkCodec codec, SimpleVector<uint8_t>& encoded,
+                  ChunkHeader& header, iovec (&buffers)[2]) {
+    header = ChunkHeader{};
+    header.magic = kChunkMagic;
+    header.count = values.GetSize();
+    header.codec = codec == ChunkCodec::None ? 0 : EncodeChunk(values, codec, encoded);
+    const void* data = values.GetData();
+    header.stored_size = values.GetSize() * sizeof(Type);
+    if (header.codec != 0) {
+        data = encoded.begin();
+        header.stored_size = encoded.GetSize();
+    }
+    header.checksum = serialization_detail::Checksum(data, header.stored_size);
+    buffers[0] = {&header, sizeof(header)};
+    buffers[1] = {const_cast<void*>(data), header.stored_size};
+}
+
+}  // namespace chunked_stream_detail
+
+// Пишет вектор кусками с текущей позиции fd. Данные копируются во
+// внутренний буфер только до заполнения куска: целые куски из Write уходят
+// в writev прямо из исходного буфера. Finish дописывает хвост и метку
+// конца; деструктор вызывает его, если это не сделано явно, но ошибки
+// тогда теряются. С codec куски сжимаются (см. compression.h);
+// несжимаемые куски пишутся как есть.
+template <typename Type>
+class ChunkedWriter {
+public:
+    explicit ChunkedWriter(int fd, size_t chunk_size = chunked_stream_detail::DefaultChunkSize<Type>(),
+                           ChunkCodec codec = ChunkCodec::None)
+        : fd_(fd), chunk_size_(chunk_size), codec_(codec) {
+        static_assert(std::is_trivially_copyable_v<Type>, "ChunkedWriter requires a trivially copyable type");
+        assert(chunk_size > 0);
+        chunked_stream_detail::WriteStreamHeader<Type>(fd_, chunk_size, codec);
+        buffer_.Reserve(chunk_size);
+    }
+
+    ChunkedWriter(const ChunkedWriter&) = delete;
+    ChunkedWriter& operator=(const ChunkedWriter&) = delete;
+
+    ~ChunkedWriter() {
+        if (!finished_) {
+            try {
+                Finish();
+            }
+            catch (...) {
+            }
+        }
+    }
+
+    size_t GetChunkSize() const noexcept {
+        return chunk_size_;
+    }
+
+    void Write(SimpleVectorView<Type> values) {
+        assert(!finished_);
+        size_t offset = 0;
+        if (!buffer_.IsEmpty()) {
+            offset = std::min(values.GetSize(), chunk_size_ - buffer_.GetSize());
+            Append(values.Subview(0, offset));
+            if (buffer_.GetSize() == chunk_size_) {
+                WriteChunk(buffer_);
+                buffer_.Clear();
+            }
+        }
+        for (; values.GetSize() - offset >= chunk_size_; offset += chunk_size_) {
+            WriteChunk(values.Subview(offset, offset + chunk_size_));
+        }
+        Append(values.Subview(offset, values.GetSize()));
+    }
+
+    void PushBack(const Type& value) {
+        assert(!finished_);
+        buffer_.PushBack(value);
+        if (buffer_.GetSize() == chunk_size_) {
+            WriteChunk(buffer_);
+            buffer_.Clear();
+        }
+    }
+
+    void Finish() {
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        if (!buffer_.IsEmpty()) {
+            WriteChunk(buffer_);
+            buffer_.Clear();
+        }
+        WriteChunk(SimpleVectorView<Type>());
+    }
+
+private:
+    void Append(SimpleVectorView<Type> values) {
+        for (const Type& value : values) {
+            buffer_.PushBack(value);
+        }
+    }
+
+    void WriteChunk(SimpleVectorView<Type> values) {
+        ChunkHeader header;
+        iovec buffers[2];
+        chunked_stream_detail::PrepareChunk(values, codec_, encoded_, header, buffers);
+        serialization_detail::WriteAll(fd_, buffers, 2);
+    }
+
+    int fd_;
+    size_t chunk_size_;
+    ChunkCodec codec_;
+    SimpleVector<Type> buffer_;
+    SimpleVector<uint8_t> encoded_;
+    bool finished_ = false;
+};
+
+// Читает поток кусков с текущей позиции fd. Фоновый поток читает
+// следующий кусок во второй буфер, пока вызывающий обрабатывает текущий.
+// Next обменивает буфер вызывающего на готовый, так что при повторном
+// использовании одного SimpleVector память не выделяется заново. Ошибки
+// фонового чтения пробрасываются из Next. fd может быть каналом или
+// сокетом: фоновое чтение ждёт данных через poll вместе с внутренним
+// каналом остановки, и деструктор прерывает его, не дожидаясь данных.
+template <typename Type>
+class ChunkedReader {
+public:
+    explicit ChunkedReader(int fd, bool verify_checksum = true) : fd_(fd), verify_checksum_(verify_checksum) {
+        static_assert(std::is_trivially_copyable_v<Type>, "ChunkedReader requires a trivially copyable type");
+        stream_ = chunked_stream_detail::ReadStreamHeader<Type>(fd_);
+        if (::pipe2(stop_pipe_, O_CLOEXEC) != 0) {
+            serialization_detail::ThrowErrno("pipe2");
+        }
+        try {
+            read_ahead_ = std::thread([this]() {
+                ReadAhead();
+            });
+        }
+        catch (...) {
+            ClosePipe();
+            throw;
+        }
+    }
+
+    ChunkedReader(const ChunkedReader&) = delete;
+    ChunkedReader& operator=(const ChunkedReader&) = delete;
+
+    ~ChunkedReader() {
+        {
+            std::lock_guard lock(mutex_);
+            stopped_ = true;
+        }
+        changed_.notify_all();
+        const char signal = 0;
+        while (::write(stop_pipe_[1], &signal, 1) < 0 && errno == EINTR) {
+        }
+        read_ahead_.join();
+        ClosePipe();
+    }
+
+    size_t GetChunkSize() const noexcept {
+        return stream_.chunk_size;
+    }
+
+    // Кладёт в chunk очередной кусок; false — поток закончился.
+    bool Next(SimpleVector<Type>& chunk) {
+        std::unique_lock lock(mutex_);
+        changed_.wait(lock, [this]() {
+            return ready_[consume_index_] || finished_ || error_;
+        });
+        if (ready_[consume_index_]) {
+            chunk.swap(slots_[consume_index_]);
+            ready_[consume_index_] = false;
+            consume_index_ ^= 1;
+            lock.unlock();
+            changed_.notify_all();
+            return true;
+        }
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+        return false;
+    }
+
+private:
+    void ClosePipe() noexcept {
+        ::close(stop_pipe_[0]);
+        ::close(stop_pipe_[1]);
+    }
+
+    void Read(void* data, size_t size) {
+        chunked_stream_detail::ReadAllOrStop(fd_, stop_pipe_[0], data, size);
+    }
+
+    // Читает кусок в buffer; false — встречена метка конца.
+    bool ReadChunk(SimpleVector<Type>& buffer) {
+        ChunkHeader header;
+        Read(&header, sizeof(header));
+        chunked_stream_detail::ValidateChunkHeader<Type>(header, stream_);
+        if (header.count == 0) {
+            return false;
+        }
+        buffer.Resize(header.count);
+        if (header.codec == 0) {
+            Read(buffer.begin(), header.stored_size);
+            chunked_stream_detail::VerifyChunk(header, buffer.begin(), verify_checksum_);
+            return true;
+        }
+        encoded_.Resize(header.stored_size);
+        Read(encoded_.begin(), header.stored_size);
+        chunked_stream_detail::VerifyChunk(header, encoded_.begin(), verify_checksum_);
+        DecodeChunk(encoded_.begin(), header.stored_size, header.codec, buffer.begin(), header.count);
+        return true;
+    }
+
+    void ReadAhead() {
+        for (size_t index = 0;; index ^= 1) {
+            {
+                std::unique_lock lock(mutex_);
+                changed_.wait(lock, [this, index]() {
+                    return !ready_[index] || stopped_;
+                });
+                if (stopped_) {
+                    return;
+                }
+            }
+            // Слот свободен: потребитель его не трогает, пока он не готов.
+            bool has_chunk = false;
+            std::exception_ptr error;
+            try {
+                has_chunk = ReadChunk(slots_[index]);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            {
+                std::lock_guard lock(mutex_);
+                if (error) {
+                    error_ = error;
+                    finished_ = true;
+                }
+                else if (has_chunk) {
+                    ready_[index] = true;
+                }
+                else {
+                    finished_ = true;
+                }
+            }
+            changed_.notify_all();
+            if (!has_chunk) {
+                return;
+            }
+        }
+    }
+
+    int fd_;
+    bool verify_checksum_;
+    StreamHeader stream_{};
+    int stop_pipe_[2] = {-1, -1};
+    SimpleVector<Type> slots_[2];
+    SimpleVector<uint8_t> encoded_;
+    bool ready_[2] = {false, false};
+    size_t consume_index_ = 0;
+    bool finished_ = false;
+    bool stopped_ = false;
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::thread read_ahead_;
+};
+
+// Записывает весь вектор потоком кусков с текущей позиции fd. Куски
+// кодируются параллельно пачками по 2 * thread_count (не больше
+// IOV_MAX / 2), каждая пачка уходит одним writev.
+template <typename Type>
+void WriteChunked(int fd, SimpleVectorView<Type> values, ChunkCodec codec = ChunkCodec::None, size_t thread_count = 1,
+                  size_t chunk_size = chunked_stream_detail::DefaultChunkSize<Type>()) {
+    static_assert(std::is_trivially_copyable_v<Type>, "WriteChunked requires a trivially copyable type");
+    assert(chunk_size > 0);
+    chunked_stream_detail::WriteStreamHeader<Type>(fd, chunk_size, codec);
+    const size_t size = values.GetSize();
+    const size_t chunk_count = (size + chunk_size - 1) / chunk_size;
+    const size_t batch_size = std::min(2 * std::max<size_t>(thread_count, 1), chunked_stream_detail::kMaxBatchChunks);
+    SimpleVector<SimpleVector<uint8_t>> encoded(batch_size);
+    SimpleVector<ChunkHeader> headers(batch_size);
+    SimpleVector<iovec> buffers(2 * batch_size);
+    for (size_t batch_begin = 0; batch_begin < chunk_count; batch_begin += batch_size) {
+        const size_t batch_count = std::min(batch_size, chunk_count - batch_begin);
+        ParallelFor(batch_count, thread_count, [&](size_t task) {
+            const size_t begin = (batch_begin + task) * chunk_size;
+            iovec chunk_buffers[2];
+            chunked_stream_detail::PrepareChunk(values.Subview(begin, std::min(size, begin + chunk_size)), codec,
+                                                encoded[task], headers[task], chunk_buffers);
+            buffers[2 * task] = chunk_buffers[0];
+            buffers[2 * task + 1] = chunk_buffers[1];
+        });
+        serialization_detail::WriteAll(fd, buffers.begin(), static_cast<int>(2 * batch_count));
+    }
+    ChunkHeader end_header;
+    iovec end_buffers[2];
+    chunked_stream_detail::PrepareChunk(SimpleVectorView<Type>(), ChunkCodec::None, encoded[0], end_header,
+                                        end_buffers);
+    serialization_detail::WriteAll(fd, end_buffers, 2);
+}
+
+template <typename Type>
+void WriteChunked(int fd, const SimpleVector<Type>& values, ChunkCodec codec = ChunkCodec::None,
+                  size_t thread_count = 1, size_t chunk_size = chunked_stream_detail::DefaultChunkSize<Type>()) {
+    WriteChunked(fd, SimpleVectorView<Type>(values), codec, thread_count, chunk_size);
+}
+
+// Читает весь поток кусков в один вектор: куски читаются последовательно
+// пачками и распаковываются параллельно прямо на свои места в результате.
+template <typename Type>
+SimpleVector<Type> ReadChunked(int fd, size_t thread_count = 1, bool verify_checksum = true) {
+    static_assert(std::is_trivially_copyable_v<Type>, "ReadChunked requires a trivially copyable type");
+    const StreamHeader stream = chunked_stream_detail::ReadStreamHeader<Type>(fd);
+    const size_t batch_size = 2 * std::max<size_t>(thread_count, 1);
+    SimpleVector<ChunkHeader> headers(batch_size);
+    SimpleVector<SimpleVector<uint8_t>> payloads(batch_size);
+    SimpleVector<size_t> offsets(batch_size);
+    SimpleVector<Type> result;
+    for (bool finished = false; !finished;) {
+        size_t batch_count = 0;
+        size_t end = result.GetSize();
+        while (batch_count < batch_size) {
+            const ChunkHeader header = chunked_stream_detail::ReadChunkHeader<Type>(fd, stream);
+            if (header.count == 0) {
+                finished = true;
+                break;
+            }
+            payloads[batch_count].Resize(header.stored_size);
+            serialization_detail::ReadAll(fd, payloads[batch_count].begin(), header.stored_size);
+            headers[batch_count] = header;
+            offsets[batch_count] = end;
+            end += header.count;
+            ++batch_count;
+        }
+        result.Resize(end);
+        ParallelFor(batch_count, thread_count, [&](size_t task) {
+            const ChunkHeader& header = headers[task];
+            chunked_stream_detail::VerifyChunk(header, payloads[task].begin(), verify_checksum);
+            DecodeChunk(payloads[task].begin(), header.stored_size, header.codec, result.begin() + offsets[task],
+                        header.count);
+        });
+    }
+    return result;
+}
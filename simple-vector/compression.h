@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+// Способ кодирования куска. Биты: 1 — LZ, 2 — перестановка байтов
+// (сначала все младшие байты элементов, затем следующие и т. д.), 4 —
+// разности соседних элементов (только для целых типов).
+enum class ChunkCodec : uint32_t {
+    None = 0,
+    Lz = 1,
+    ShuffleLz = 3,
+    DeltaShuffleLz = 7,
+};
+
+namespace compression_detail {
+
+constexpr uint32_t kLzFlag = 1;
+constexpr uint32_t kShuffleFlag = 2;
+constexpr uint32_t kDeltaFlag = 4;
+constexpr uint32_t kKnownFlags = kLzFlag | kShuffleFlag | kDeltaFlag;
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 65535;
+constexpr unsigned kHashBits = 14;
+
+[[noreturn]] inline void ThrowCorrupted() {
+    using namespace std::string_literals;
+    throw std::runtime_error("Corrupted compressed chunk"s);
+}
+
+inline uint32_t Load32(const uint8_t* data) noexcept {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint32_t HashSequence(uint32_t sequence) noexcept {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+inline size_t MaxCompressedSize(size_t size) noexcept {
+    return size + size / 255 + 16;
+}
+
+inline uint8_t* WriteLength(uint8_t* output, size_t length) noexcept {
+    for (; length >= 255; length -= 255) {
+        *output++ = 255;
+    }
+    *output++ = static_cast<uint8_t>(length);
+    return output;
+}
+
+inline uint8_t* WriteSequence(uint8_t* output, const uint8_t* literals, size_t literal_count, size_t offset,
+                              size_t match_length) noexcept {
+    uint8_t* token = output++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literal_count, 15) << 4);
+    if (literal_count >= 15) {
+        output = WriteLength(output, literal_count - 15);
+    }
+    std::memcpy(output, literals, literal_count);
+    output += literal_count;
+    if (match_length == 0) {
+        return output;
+    }
+    *output++ = static_cast<uint8_t>(offset);
+    *output++ = static_cast<uint8_t>(offset >> 8);
+    const size_t extra = match_length - kMinMatch;
+    *token |= static_cast<uint8_t>(std::min<size_t>(extra, 15));
+    if (extra >= 15) {
+        output = WriteLength(output, extra - 15);
+    }
+    return output;
+}
+
+// Блочный LZ77 в духе LZ4: последовательности «литералы + совпадение»,
+// совпадения ищутся по хешу четырёх байт в окне 64 КиБ. При долгом
+// отсутствии совпадений шаг поиска растёт, чтобы несжимаемые данные
+// проходили быстро. Возвращает размер сжатых данных в output, который
+// должен вмещать MaxCompressedSize(size) байт.
+inline size_t LzCompress(const uint8_t* input, size_t size, uint8_t* output) noexcept {
+    uint32_t table[size_t{1} << kHashBits] = {};
+    uint8_t* const output_begin = output;
+    size_t anchor = 0;
+    size_t position = 0;
+    while (position + kMinMatch <= size) {
+        const uint32_t sequence = Load32(input + position);
+        const uint32_t hash = HashSequence(sequence);
+        const size_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(position);
+        if (candidate < position && position - candidate <= kMaxOffset && Load32(input + candidate) == sequence) {
+            size_t length = kMinMatch;
+            while (position + length < size && input[candidate + length] == input[position + length]) {
+                ++length;
+            }
+            output = WriteSequence(output, input + anchor, position - anchor, position - candidate, length);
+            position += length;
+            anchor = position;
+        }
+        else {
+            position += 1 + ((position - anchor) >> 6);
+        }
+    }
+    output = WriteSequence(output, input + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(output - output_begin);
+}
+
+inline size_t ReadLength(const uint8_t*& input, const uint8_t* input_end) {
+    size_t length = 0;
+    uint8_t byte;
+    do {
+        if (input == input_end) {
+            ThrowCorrupted();
+        }
+        byte = *input++;
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+// Распаковка с проверкой всех границ: испорченный вход даёт исключение,
+// а не выход за буфер. Результат должен занять ровно output_size байт.
+inline void LzDecompress(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size) {
+    const uint8_t* const input_end = input + input_size;
+    uint8_t* const output_begin = output;
+    uint8_t* const output_end = output + output_size;
+    while (input < input_end) {
+        const uint8_t token = *input++;
+        size_t literal_count = token >> 4;
+        if (literal_count == 15) {
+            literal_count += ReadLength(input, input_end);
+        }
+        if (literal_count > static_cast<size_t>(input_end - input) ||
+            literal_count > static_cast<size_t>(output_end - output)) {
+            ThrowCorrupted();
+        }
+        std::memcpy(output, input, literal_count);
+        input += literal_count;
+        output += literal_count;
+        if (input == input_end) {
+            break;
+        }
+        if (input_end - input < 2) {
+            ThrowCorrupted();
+        }
+        const size_t offset = input[0] | (size_t{input[1]} << 8);
+        input += 2;
+        size_t match_length = (token & 15) + kMinMatch;
+        if ((token & 15) == 15) {
+            match_length += ReadLength(input, input_end);
+        }
+        if (offset == 0 || offset > static_cast<size_t>(output - output_begin) ||
+            match_length > static_cast<size_t>(output_end - output)) {
+            ThrowCorrupted();
+        }
+        const uint8_t* match = output - offset;
+        if (offset >= match_length) {
+            std::memcpy(output, match, match_length);
+            output += match_length;
+        }
+        else {
+            for (size_t index = 0; index < match_length; ++index) {
+                *output++ = match[index];
+            }
+        }
+    }
+    if (output != output_end) {
+        ThrowCorrupted();
+    }
+}
+
+// Байт b элемента i переходит в позицию b * count + i: одноимённые байты
+// соседних чисел обычно похожи, и LZ находит больше совпадений.
+inline void ByteShuffle(const uint8_t* input, size_t count, size_t element_size, uint8_t* output) noexcept {
+    for (size_t byte = 0; byte < element_size; ++byte) {
+        uint8_t* lane = output + byte * count;
+        for (size_t index = 0; index < count; ++index) {
+            lane[index] = input[index * element_size + byte];
+        }
+    }
+}
+
+inline void ByteUnshuffle(const uint8_t* input, size_t count, size_t element_size, uint8_t* output) noexcept {
+    for (size_t byte = 0; byte < element_size; ++byte) {
+        const uint8_t* lane = input + byte * count;
+        for (size_t index = 0; index < count; ++index) {
+            output[index * element_size + byte] = lane[index];
+        }
+    }
+}
+
+// Разности считаются в беззнаковом типе: переполнение обратимо.
+template <typename Type>
+void DeltaEncode(const Type* input, size_t count, Type* output) noexcept {
+    using Unsigned = std::make_unsigned_t<Type>;
+    Unsigned previous = 0;
+    for (size_t index = 0; index < count; ++index) {
+        const auto value = static_cast<Unsigned>(input[index]);
+        output[index] = static_cast<Type>(static_cast<Unsigned>(value - previous));
+        previous = value;
+    }
+}
+
+template <typename Type>
+void DeltaDecode(Type* values, size_t count) noexcept {
+    using Unsigned = std::make_unsigned_t<Type>;
+    Unsigned sum = 0;
+    for (size_t index = 0; index < count; ++index) {
+        sum = static_cast<Unsigned>(sum + static_cast<Unsigned>(values[index]));
+        values[index] = static_cast<Type>(sum);
+    }
+}
+
+template <typename Type>
+constexpr uint32_t SupportedFlags(ChunkCodec codec) noexcept {
+    uint32_t flags = static_cast<uint32_t>(codec);
+    if constexpr (!std::is_integral_v<Type> || std::is_same_v<Type, bool>) {
+        flags &= ~kDeltaFlag;
+    }
+    if (sizeof(Type) == 1) {
+        flags &= ~kShuffleFlag;
+    }
+    return flags;
+}
+
+}  // namespace compression_detail
+
+// Кодирует кусок в output. Возвращает применённые флаги; 0 — сжатие не
+// дало выигрыша, output пуст и кусок нужно хранить как есть.
+template <typename Type>
+uint32_t EncodeChunk(SimpleVectorView<Type> values, ChunkCodec codec, SimpleVector<uint8_t>& output) {
+    static_assert(std::is_trivially_copyable_v<Type>, "EncodeChunk requires a trivially copyable type");
+    using namespace compression_detail;
+    const uint32_t flags = SupportedFlags<Type>(codec);
+    const size_t count = values.GetSize();
+    const size_t size = count * sizeof(Type);
+    output.Clear();
+    if ((flags & kLzFlag) == 0 || size == 0) {
+        return 0;
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(values.GetData());
+    SimpleVector<Type> deltas;
+    if constexpr (std::is_integral_v<Type> && !std::is_same_v<Type, bool>) {
+        if (flags & kDeltaFlag) {
+            deltas.Resize(count);
+            DeltaEncode(values.GetData(), count, deltas.begin());
+            bytes = reinterpret_cast<const uint8_t*>(deltas.begin());
+        }
+    }
+    SimpleVector<uint8_t> shuffled;
+    if (flags & kShuffleFlag) {
+        shuffled.Resize(size);
+        ByteShuffle(bytes, count, sizeof(Type), shuffled.begin());
+        bytes = shuffled.begin();
+    }
+    output.Resize(MaxCompressedSize(size));
+    const size_t compressed_size = LzCompress(bytes, size, output.begin());
+    if (compressed_size >= size) {
+        output.Clear();
+        return 0;
+    }
+    output.Resize(compressed_size);
+    return flags;
+}
+
+// Восстанавливает count элементов в output из закодированного куска.
+template <typename Type>
+void DecodeChunk(const uint8_t* data, size_t size, uint32_t flags, Type* output, size_t count) {
+    static_assert(std::is_trivially_copyable_v<Type>, "DecodeChunk requires a trivially copyable type");
+    using namespace compression_detail;
+    const size_t raw_size = count * sizeof(Type);
+    if ((flags & ~kKnownFlags) != 0 || (flags != 0 && (flags & kLzFlag) == 0) ||
+        (flags & ~SupportedFlags<Type>(ChunkCodec::DeltaShuffleLz)) != 0) {
+        ThrowCorrupted();
+    }
+    auto* bytes = reinterpret_cast<uint8_t*>(output);
+    if (flags == 0) {
+        if (size != raw_size) {
+            ThrowCorrupted();
+        }
+        std::memcpy(bytes, data, size);
+        return;
+    }
+    if (flags & kShuffleFlag) {
+        SimpleVector<uint8_t> shuffled(raw_size);
+        LzDecompress(data, size, shuffled.begin(), raw_size);
+        ByteUnshuffle(shuffled.begin(), count, sizeof(Type), bytes);
+    }
+    else {
+        LzDecompress(data, size, bytes, raw_size);
+    }
+    if constexpr (std::is_integral_v<Type> && !std::is_same_v<Type, bool>) {
+        if (flags & kDeltaFlag) {
+            DeltaDecode(output, count);
+        }
+    }
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "shared_buffer.h"
+#include "simple_vector.h"
+
+// Вектор с копированием при записи: копии разделяют один буфер, а
+// собственная копия данных создаётся при первом изменяющем вызове. Все
+// неконстантные методы (в том числе неконстантные operator[], At, begin и
+// end) отделяют буфер, поэтому только для чтения стоит пользоваться
+// константной ссылкой, cbegin/cend или GetItems(). Выданная ими изменяемая
+// ссылка или итератор делает буфер неразделяемым, как в старой COW-строке
+// libstdc++: копии такого вектора получают собственные данные сразу, и
+// запись по ссылке не видна в копиях. Метка снимается при Clear и
+// присваивании.
+template <typename Type>
+class CowVector {
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    CowVector() noexcept = default;
+
+    explicit CowVector(size_t size) : buffer_(SimpleVector<Type>(size)) {
+    }
+
+    CowVector(size_t size, const Type& value) : buffer_(SimpleVector<Type>(size, value)) {
+    }
+
+    CowVector(std::initializer_list<Type> init) : buffer_(SimpleVector<Type>(init)) {
+    }
+
+    explicit CowVector(SimpleVector<Type> items) : buffer_(std::move(items)) {
+    }
+
+    CowVector(const CowVector& other) : buffer_(other.Share()) {
+    }
+
+    CowVector(CowVector&& other) noexcept
+        : buffer_(std::move(other.buffer_)), unshareable_(std::exchange(other.unshareable_, false)) {
+    }
+
+    CowVector& operator=(const CowVector& rhs) {
+        if (this != &rhs) {
+            CowVector copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept {
+        if (this != &rhs) {
+            CowVector moved(std::move(rhs));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    size_t GetSize() const noexcept {
+        return buffer_ ? buffer_.Get().GetSize() : 0;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return buffer_ ? buffer_.Get().GetCapacity() : 0;
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Число векторов, разделяющих буфер.
+    size_t UseCount() const noexcept {
+        return buffer_.UseCount();
+    }
+
+    bool IsShared() const noexcept {
+        return buffer_.UseCount() > 1;
+    }
+
+    const SimpleVector<Type>& GetItems() const noexcept {
+        return buffer_ ? buffer_.Get() : Empty();
+    }
+
+    // Буфер для разделения с другими контейнерами, например SharedSlice;
+    // у неразделяемого вектора — копия данных.
+    SharedBuffer<Type> GetBuffer() const {
+        return Share();
+    }
+
+    // Гарантирует единоличное владение буфером, копируя его при необходимости.
+    void MakeUnique() {
+        if (buffer_.IsUnique()) {
+            return;
+        }
+        SharedBuffer<Type> copy(buffer_ ? SimpleVector<Type>(buffer_.Get()) : SimpleVector<Type>());
+        buffer_.swap(copy);
+    }
+
+    Type& operator[](size_t index) {
+        assert(index < GetSize());
+        return Leak()[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return buffer_.Get()[index];
+    }
+
+    Type& At(size_t index) {
+        CheckIndex(index);
+        return Leak()[index];
+    }
+
+    const Type& At(size_t index) const {
+        CheckIndex(index);
+        return buffer_.Get()[index];
+    }
+
+    // Разделяемый буфер не копируется, а просто отпускается.
+    void Clear() noexcept {
+        unshareable_ = false;
+        if (buffer_.IsUnique()) {
+            buffer_.GetMutable().Clear();
+        }
+        else {
+            buffer_.Reset();
+        }
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (buffer_.IsUnique()) {
+            buffer_.GetMutable().Reserve(new_capacity);
+            return;
+        }
+        SimpleVector<Type> items;
+        items.Reserve(std::max(new_capacity, GetSize()));
+        for (const Type& item : GetItems()) {
+            items.PushBack(item);
+        }
+        SharedBuffer<Type> copy(std::move(items));
+        buffer_.swap(copy);
+    }
+
+    void Resize(size_t new_size) {
+        Items().Resize(new_size);
+    }
+
+    void PushBack(const Type& item) {
+        Items().PushBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        Items().PushBack(std::move(item));
+    }
+
+    // Позиции переводятся в индексы до отделения буфера.
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        const size_t index = pos - cbegin();
+        auto& items = Items();
+        return items.Insert(items.begin() + index, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        const size_t index = pos - cbegin();
+        auto& items = Items();
+        return items.Insert(items.begin() + index, std::move(value));
+    }
+
+    void PopBack() {
+        assert(!IsEmpty());
+        Items().PopBack();
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        const size_t index = pos - cbegin();
+        auto& items = Items();
+        return items.Erase(items.begin() + index);
+    }
+
+    void swap(CowVector& other) noexcept {
+        buffer_.swap(other.buffer_);
+        std::swap(unshareable_, other.unshareable_);
+    }
+
+    Iterator begin() {
+        return buffer_ ? Leak().begin() : nullptr;
+    }
+
+    Iterator end() {
+        return buffer_ ? Leak().end() : nullptr;
+    }
+
+    ConstIterator begin() const noexcept {
+        return GetItems().begin();
+    }
+
+    ConstIterator end() const noexcept {
+        return GetItems().end();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return GetItems().begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return GetItems().end();
+    }
+
+private:
+    static const SimpleVector<Type>& Empty() noexcept {
+        static const SimpleVector<Type> empty;
+        return empty;
+    }
+
+    void CheckIndex(size_t index) const {
+        if (index >= GetSize()) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+    }
+
+    SimpleVector<Type>& Items() {
+        MakeUnique();
+        return buffer_.GetMutable();
+    }
+
+    // Для методов, отдающих наружу изменяемую ссылку или итератор.
+    SimpleVector<Type>& Leak() {
+        SimpleVector<Type>& items = Items();
+        unshareable_ = true;
+        return items;
+    }
+
+    SharedBuffer<Type> Share() const {
+        if (unshareable_ && buffer_) {
+            return SharedBuffer<Type>(SimpleVector<Type>(buffer_.Get()));
+        }
+        return buffer_;
+    }
+
+    SharedBuffer<Type> buffer_;
+    bool unshareable_ = false;
+};
+
+template <typename Type>
+inline bool operator==(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return lhs.GetItems() == rhs.GetItems();
+}
+
+template <typename Type>
+inline bool operator!=(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type>
+inline bool operator<(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return lhs.GetItems() < rhs.GetItems();
+}
+
+template <typename Type>
+inline bool operator<=(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type>
+inline bool operator>(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type>
+inline bool operator>=(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return !(lhs < rhs);
+}
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+enum class CompareOp {
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual,
+};
+
+namespace filter_detail {
+
+template <typename Type>
+struct Identity {
+    using type = Type;
+};
+
+template <typename Type>
+using NonDeduced = typename Identity<Type>::type;
+
+inline unsigned CountTrailingZeros(uint64_t word) noexcept {
+    assert(word != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+inline unsigned PopCount(uint64_t word) noexcept {
+#if defined(_MSC_VER)
+    return static_cast<unsigned>(__popcnt64(word));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(word));
+#endif
+}
+
+// Вызывает function с функтором сравнения, соответствующим op. Ядра
+// инстанцируются для каждого функтора отдельно, без ветвлений во внутреннем цикле.
+template <typename Type, typename Function>
+void DispatchCompare(CompareOp op, Function function) {
+    switch (op) {
+    case CompareOp::Less:
+        function(std::less<Type>{});
+        break;
+    case CompareOp::LessEqual:
+        function(std::less_equal<Type>{});
+        break;
+    case CompareOp::Greater:
+        function(std::greater<Type>{});
+        break;
+    case CompareOp::GreaterEqual:
+        function(std::greater_equal<Type>{});
+        break;
+    case CompareOp::Equal:
+        function(std::equal_to<Type>{});
+        break;
+    case CompareOp::NotEqual:
+        function(std::not_equal_to<Type>{});
+        break;
+    }
+}
+
+#if defined(__AVX2__)
+
+template <typename Type>
+constexpr bool kHasAvx2Kernel = std::is_same_v<Type, int32_t> || std::is_same_v<Type, float>;
+
+// Таблица перестановок для упаковки выбранных 32-битных дорожек в начало регистра.
+struct CompressTable {
+    constexpr CompressTable() : lanes() {
+        for (int mask = 0; mask < 256; ++mask) {
+            int count = 0;
+            for (int lane = 0; lane < 8; ++lane) {
+                if (mask & (1 << lane)) {
+                    lanes[mask][count++] = lane;
+                }
+            }
+            for (; count < 8; ++count) {
+                lanes[mask][count] = 0;
+            }
+        }
+    }
+
+    alignas(32) int32_t lanes[256][8];
+};
+
+inline const CompressTable& GetCompressTable() noexcept {
+    static constexpr CompressTable table;
+    return table;
+}
+
+inline unsigned CompareBlock(const int32_t* values, __m256i operand, CompareOp op) noexcept {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+    auto bits = [](__m256i mask) {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+    };
+    switch (op) {
+    case CompareOp::Less:
+        return bits(_mm256_cmpgt_epi32(operand, block));
+    case CompareOp::LessEqual:
+        return bits(_mm256_cmpgt_epi32(block, operand)) ^ 0xFFu;
+    case CompareOp::Greater:
+        return bits(_mm256_cmpgt_epi32(block, operand));
+    case CompareOp::GreaterEqual:
+        return bits(_mm256_cmpgt_epi32(operand, block)) ^ 0xFFu;
+    case CompareOp::Equal:
+        return bits(_mm256_cmpeq_epi32(block, operand));
+    case CompareOp::NotEqual:
+        return bits(_mm256_cmpeq_epi32(block, operand)) ^ 0xFFu;
+    }
+    return 0;
+}
+
+inline unsigned CompareBlock(const float* values, __m256 operand, CompareOp op) noexcept {
+    const __m256 block = _mm256_loadu_ps(values);
+    switch (op) {
+    case CompareOp::Less:
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(block, operand, _CMP_LT_OQ)));
+    case CompareOp::LessEqual:
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(block, operand, _CMP_LE_OQ)));
+    case CompareOp::Greater:
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(block, operand, _CMP_GT_OQ)));
+    case CompareOp::GreaterEqual:
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(block, operand, _CMP_GE_OQ)));
+    case CompareOp::Equal:
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(block, operand, _CMP_EQ_OQ)));
+    case CompareOp::NotEqual:
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(block, operand, _CMP_NEQ_UQ)));
+    }
+    return 0;
+}
+
+inline __m256i Broadcast(int32_t value) noexcept {
+    return _mm256_set1_epi32(value);
+}
+
+inline __m256 Broadcast(float value) noexcept {
+    return _mm256_set1_ps(value);
+}
+
+// Заполняет маску для кратной восьми части values и возвращает её длину.
+template <typename Type>
+size_t BuildMaskAvx2(const Type* values, size_t size, Type operand, CompareOp op, uint64_t* words) noexcept {
+    const auto broadcast = Broadcast(operand);
+    const size_t blocks_size = size / 8 * 8;
+    for (size_t index = 0; index < blocks_size; index += 8) {
+        const uint64_t bits = CompareBlock(values + index, broadcast, op);
+        words[index / 64] |= bits << (index % 64);
+    }
+    return blocks_size;
+}
+
+// Упаковывает выбранные элементы кратной восьми части values в output.
+// Возвращает число обработанных элементов и записанных значений.
+template <typename Type>
+std::pair<size_t, size_t> CompactAvx2(const Type* values, size_t size, Type operand, CompareOp op, Type* output) noexcept {
+    const auto broadcast = Broadcast(operand);
+    const CompressTable& table = GetCompressTable();
+    const size_t blocks_size = size / 8 * 8;
+    size_t count = 0;
+    for (size_t index = 0; index < blocks_size; index += 8) {
+        const unsigned bits = CompareBlock(values + index, broadcast, op);
+        const __m256i permutation = _mm256_load_si256(reinterpret_cast<const __m256i*>(table.lanes[bits]));
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + index));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + count), _mm256_permutevar8x32_epi32(block, permutation));
+        count += PopCount(bits);
+    }
+    return {blocks_size, count};
+}
+
+#endif
+
+}  // namespace filter_detail
+
+// Битовая маска: бит i слова i / 64 установлен, если values[i] op operand.
+template <typename Type>
+SimpleVector<uint64_t> FilterMask(SimpleVectorView<Type> values, CompareOp op,
+                                  filter_detail::NonDeduced<Type> operand) {
+    static_assert(std::is_arithmetic_v<Type>, "FilterMask requires an arithmetic type");
+    const size_t size = values.GetSize();
+    SimpleVector<uint64_t> mask((size + 63) / 64);
+    const Type* data = values.begin();
+    size_t done = 0;
+#if defined(__AVX2__)
+    if constexpr (filter_detail::kHasAvx2Kernel<Type>) {
+        done = filter_detail::BuildMaskAvx2(data, size, operand, op, mask.begin());
+    }
+#endif
+    filter_detail::DispatchCompare<Type>(op, [&](auto compare) {
+        for (size_t index = done; index < size; ++index) {
+            mask[index / 64] |= static_cast<uint64_t>(compare(data[index], operand)) << (index % 64);
+        }
+    });
+    return mask;
+}
+
+template <typename Type>
+SimpleVector<uint64_t> FilterMask(const SimpleVector<Type>& values, CompareOp op,
+                                  filter_detail::NonDeduced<Type> operand) {
+    return FilterMask(SimpleVectorView<Type>(values), op, operand);
+}
+
+template <typename Type>
+SimpleVector<uint64_t> FilterMask(MutableSimpleVectorView<Type> values, CompareOp op,
+                                  filter_detail::NonDeduced<Type> operand) {
+    return FilterMask(SimpleVectorView<Type>(values), op, operand);
+}
+
+// Вектор выбора: индексы установленных битов маски по возрастанию.
+inline SimpleVector<uint32_t> MaskToSelection(const SimpleVector<uint64_t>& mask) {
+    assert(mask.GetSize() <= (size_t{std::numeric_limits<uint32_t>::max()} + 1) / 64);
+    size_t count = 0;
+    for (uint64_t word : mask) {
+        count += filter_detail::PopCount(word);
+    }
+    SimpleVector<uint32_t> selection(count);
+    size_t position = 0;
+    for (size_t word_index = 0; word_index < mask.GetSize(); ++word_index) {
+        uint64_t word = mask[word_index];
+        while (word != 0) {
+            selection[position++] = static_cast<uint32_t>(word_index * 64 + filter_detail::CountTrailingZeros(word));
+            word &= word - 1;
+        }
+    }
+    return selection;
+}
+
+template <typename Type>
+SimpleVector<uint32_t> FilterSelection(SimpleVectorView<Type> values, CompareOp op,
+                                       filter_detail::NonDeduced<Type> operand) {
+    return MaskToSelection(FilterMask(values, op, operand));
+}
+
+template <typename Type>
+SimpleVector<uint32_t> FilterSelection(const SimpleVector<Type>& values, CompareOp op,
+                                       filter_detail::NonDeduced<Type> operand) {
+    return MaskToSelection(FilterMask(values, op, operand));
+}
+
+template <typename Type>
+SimpleVector<uint32_t> FilterSelection(MutableSimpleVectorView<Type> values, CompareOp op,
+                                       filter_detail::NonDeduced<Type> operand) {
+    return MaskToSelection(FilterMask(values, op, operand));
+}
+
+// Значения, для которых установлен бит маски, в исходном порядке. Биты
+// за концом values (хвост последнего слова и лишние слова) не учитываются.
+template <typename Type>
+SimpleVector<Type> Compact(SimpleVectorView<Type> values, const SimpleVector<uint64_t>& mask) {
+    assert(mask.GetSize() * 64 >= values.GetSize());
+    const size_t word_count = std::min(mask.GetSize(), (values.GetSize() + 63) / 64);
+    auto word_at = [&mask, &values](size_t word_index) {
+        const size_t tail = values.GetSize() - word_index * 64;
+        return tail >= 64 ? mask[word_index] : mask[word_index] & ((uint64_t{1} << tail) - 1);
+    };
+    size_t count = 0;
+    for (size_t word_index = 0; word_index < word_count; ++word_index) {
+        count += filter_detail::PopCount(word_at(word_index));
+    }
+    SimpleVector<Type> result(count);
+    size_t position = 0;
+    for (size_t word_index = 0; word_index < word_count; ++word_index) {
+        uint64_t word = word_at(word_index);
+        while (word != 0) {
+            result[position++] = values[word_index * 64 + filter_detail::CountTrailingZeros(word)];
+            word &= word - 1;
+        }
+    }
+    return result;
+}
+
+template <typename Type>
+SimpleVector<Type> Compact(const SimpleVector<Type>& values, const SimpleVector<uint64_t>& mask) {
+    return Compact(SimpleVectorView<Type>(values), mask);
+}
+
+template <typename Type>
+SimpleVector<Type> Compact(MutableSimpleVectorView<Type> values, const SimpleVector<uint64_t>& mask) {
+    return Compact(SimpleVectorView<Type>(values), mask);
+}
+
+// Фильтр без промежуточной маски: запись без ветвлений, на AVX2 —
+// упаковка через таблицу перестановок.
+template <typename Type>
+SimpleVector<Type> Filter(SimpleVectorView<Type> values, CompareOp op, filter_detail::NonDeduced<Type> operand) {
+    static_assert(std::is_arithmetic_v<Type>, "Filter requires an arithmetic type");
+    const size_t size = values.GetSize();
+    SimpleVector<Type> result(size);
+    const Type* data = values.begin();
+    Type* output = result.begin();
+    size_t done = 0;
+    size_t count = 0;
+#if defined(__AVX2__)
+    if constexpr (filter_detail::kHasAvx2Kernel<Type>) {
+        std::tie(done, count) = filter_detail::CompactAvx2(data, size, operand, op, output);
+    }
+#endif
+    filter_detail::DispatchCompare<Type>(op, [&](auto compare) {
+        for (size_t index = done; index < size; ++index) {
+            output[count] = data[index];
+            count += static_cast<size_t>(compare(data[index], operand));
+        }
+    });
+    result.Resize(count);
+    return result;
+}
+
+template <typename Type>
+SimpleVector<Type> Filter(const SimpleVector<Type>& values, CompareOp op, filter_detail::NonDeduced<Type> operand) {
+    return Filter(SimpleVectorView<Type>(values), op, operand);
+}
+
+template <typename Type>
+SimpleVector<Type> Filter(MutableSimpleVectorView<Type> values, CompareOp op, filter_detail::NonDeduced<Type> operand) {
+    return Filter(SimpleVectorView<Type>(values), op, operand);
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "array_ptr.h"
+
+// Буфер с разрывом: элементы лежат в [0, gap_begin_) и [gap_end_, capacity_),
+// курсор совпадает с началом разрыва. Вставка и удаление у курсора — O(1)
+// амортизированно, перемещение курсора — O(расстояние).
+template <typename Type>
+class GapVector {
+public:
+    // Непрерывный участок элементов.
+    struct Span {
+        Type* data = nullptr;
+        size_t size = 0;
+    };
+
+    struct ConstSpan {
+        const Type* data = nullptr;
+        size_t size = 0;
+    };
+
+    GapVector() noexcept = default;
+
+    explicit GapVector(size_t capacity) : capacity_(capacity), gap_end_(capacity), items_(capacity) {
+    }
+
+    GapVector(const GapVector& other) : GapVector(other.capacity_) {
+        std::copy(other.items_.Get(), other.items_.Get() + other.gap_begin_, items_.Get());
+        std::copy(other.items_.Get() + other.gap_end_, other.items_.Get() + other.capacity_,
+                  items_.Get() + other.gap_end_);
+        gap_begin_ = other.gap_begin_;
+        gap_end_ = other.gap_end_;
+    }
+
+    GapVector(GapVector&& other) noexcept
+        : capacity_(std::exchange(other.capacity_, 0)),
+          gap_begin_(std::exchange(other.gap_begin_, 0)),
+          gap_end_(std::exchange(other.gap_end_, 0)),
+          items_(std::move(other.items_)) {
+    }
+
+    GapVector& operator=(const GapVector& rhs) {
+        if (this != &rhs) {
+            GapVector copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    GapVector& operator=(GapVector&& rhs) noexcept {
+        if (this != &rhs) {
+            swap(rhs);
+        }
+        return *this;
+    }
+
+    size_t GetSize() const noexcept {
+        return capacity_ - (gap_end_ - gap_begin_);
+    }
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    size_t GetCursor() const noexcept {
+        return gap_begin_;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < GetSize());
+        return items_[Physical(index)];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return items_[Physical(index)];
+    }
+
+    Type& At(size_t index) {
+        if (index >= GetSize()) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+        return items_[Physical(index)];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+        return items_[Physical(index)];
+    }
+
+    // Переносит разрыв так, чтобы перед курсором было position элементов.
+    // Перемещаются только элементы между старой и новой позициями.
+    void MoveCursor(size_t position) {
+        assert(position <= GetSize());
+        if (position < gap_begin_) {
+            const size_t count = gap_begin_ - position;
+            std::move_backward(items_.Get() + position, items_.Get() + gap_begin_, items_.Get() + gap_end_);
+            gap_begin_ -= count;
+            gap_end_ -= count;
+        }
+        else if (position > gap_begin_) {
+            const size_t count = position - gap_begin_;
+            std::move(items_.Get() + gap_end_, items_.Get() + gap_end_ + count, items_.Get() + gap_begin_);
+            gap_begin_ += count;
+            gap_end_ += count;
+        }
+    }
+
+    // Вставляет элемент у курсора; курсор остаётся после вставленного.
+    void Insert(const Type& value) {
+        EnsureGap(1);
+        items_[gap_begin_++] = value;
+    }
+
+    void Insert(Type&& value) {
+        EnsureGap(1);
+        items_[gap_begin_++] = std::move(value);
+    }
+
+    template <typename ForwardIt>
+    void Insert(ForwardIt first, ForwardIt last) {
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        EnsureGap(count);
+        std::copy(first, last, items_.Get() + gap_begin_);
+        gap_begin_ += count;
+    }
+
+    void InsertAt(size_t position, const Type& value) {
+        MoveCursor(position);
+        Insert(value);
+    }
+
+    void InsertAt(size_t position, Type&& value) {
+        MoveCursor(position);
+        Insert(std::move(value));
+    }
+
+    // Удаляет count элементов перед курсором (как Backspace).
+    void EraseBefore(size_t count = 1) noexcept {
+        assert(count <= gap_begin_);
+        gap_begin_ -= count;
+    }
+
+    // Удаляет count элементов после курсора (как Delete).
+    void EraseAfter(size_t count = 1) noexcept {
+        assert(count <= capacity_ - gap_end_);
+        gap_end_ += count;
+    }
+
+    void EraseAt(size_t position) {
+        MoveCursor(position);
+        EraseAfter(1);
+    }
+
+    void PushBack(const Type& value) {
+        InsertAt(GetSize(), value);
+    }
+
+    void PushBack(Type&& value) {
+        InsertAt(GetSize(), std::move(value));
+    }
+
+    void Clear() noexcept {
+        gap_begin_ = 0;
+        gap_end_ = capacity_;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    // Содержимое как два непрерывных участка: до курсора и после него.
+    std::pair<Span, Span> GetSpans() noexcept {
+        return {{items_.Get(), gap_begin_}, {items_.Get() + gap_end_, capacity_ - gap_end_}};
+    }
+
+    std::pair<ConstSpan, ConstSpan> GetSpans() const noexcept {
+        return {{items_.Get(), gap_begin_}, {items_.Get() + gap_end_, capacity_ - gap_end_}};
+    }
+
+    template <typename Function>
+    void ForEach(Function function) const {
+        std::for_each(items_.Get(), items_.Get() + gap_begin_, function);
+        std::for_each(items_.Get() + gap_end_, items_.Get() + capacity_, function);
+    }
+
+    void swap(GapVector& other) noexcept {
+        items_.swap(other.items_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(gap_begin_, other.gap_begin_);
+        std::swap(gap_end_, other.gap_end_);
+    }
+
+private:
+    size_t Physical(size_t index) const noexcept {
+        return index < gap_begin_ ? index : index + (gap_end_ - gap_begin_);
+    }
+
+    void EnsureGap(size_t count) {
+        if (gap_end_ - gap_begin_ < count) {
+            Reallocate(std::max(GetSize() + count, capacity_ * 2));
+        }
+    }
+
+    void Reallocate(size_t new_capacity) {
+        const size_t tail = capacity_ - gap_end_;
+        ArrayPtr<Type> new_items(new_capacity);
+        std::move(items_.Get(), items_.Get() + gap_begin_, new_items.Get());
+        std::move(items_.Get() + gap_end_, items_.Get() + capacity_, new_items.Get() + (new_capacity - tail));
+        items_.swap(new_items);
+        capacity_ = new_capacity;
+        gap_end_ = new_capacity - tail;
+    }
+
+    size_t capacity_ = 0;
+    size_t gap_begin_ = 0;
+    size_t gap_end_ = 0;
+    ArrayPtr<Type> items_;
+};
+
+template <typename Type>
+bool operator==(const GapVector<Type>& lhs, const GapVector<Type>& rhs) {
+    if (lhs.GetSize() != rhs.GetSize()) {
+        return false;
+    }
+    for (size_t index = 0; index < lhs.GetSize(); ++index) {
+        if (!(lhs[index] == rhs[index])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Type>
+bool operator!=(const GapVector<Type>& lhs, const GapVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#include "hash_utils.h"
+#include "parallel.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+template <typename Key, typename Value>
+struct GroupByResult {
+    struct Column {
+        SimpleVector<Value> sums;
+        SimpleVector<Value> mins;
+        SimpleVector<Value> maxs;
+    };
+
+    size_t GetGroupCount() const noexcept {
+        return keys.GetSize();
+    }
+
+    SimpleVector<Key> keys;
+    SimpleVector<size_t> counts;
+    // columns[c] соответствует c-му столбцу, добавленному через AddValues.
+    SimpleVector<Column> columns;
+};
+
+namespace group_by_detail {
+
+constexpr size_t kNoGroup = std::numeric_limits<size_t>::max();
+
+// Плотный путь выгоден, пока диапазон ключей сопоставим с числом строк.
+// Диапазон до kDenseRangeMin берётся всегда, больший — только в пределах
+// kDenseRangePerRow на строку, чтобы крошечный вход не обнулял и не
+// обходил таблицу, во много раз большую его самого.
+constexpr uint64_t kDenseRangePerRow = 4;
+constexpr uint64_t kDenseRangeMin = 1024;
+
+// Агрегирует столбцы по уже вычисленным номерам групп строк.
+template <typename Key, typename Value, typename RowAt>
+void AggregateColumns(GroupByResult<Key, Value>& result, const SimpleVector<SimpleVectorView<Value>>& columns,
+                      const SimpleVector<size_t>& group_ids, RowAt row_at) {
+    const size_t group_count = result.keys.GetSize();
+    const size_t row_count = group_ids.GetSize();
+    result.counts = SimpleVector<size_t>(group_count);
+    for (size_t row = 0; row < row_count; ++row) {
+        ++result.counts[group_ids[row]];
+    }
+    result.columns = SimpleVector<typename GroupByResult<Key, Value>::Column>(columns.GetSize());
+    for (size_t column_index = 0; column_index < columns.GetSize(); ++column_index) {
+        const Value* values = columns[column_index].begin();
+        auto& column = result.columns[column_index];
+        column.sums = SimpleVector<Value>(group_count);
+        column.mins = SimpleVector<Value>(group_count, std::numeric_limits<Value>::max());
+        column.maxs = SimpleVector<Value>(group_count, std::numeric_limits<Value>::lowest());
+        for (size_t row = 0; row < row_count; ++row) {
+            const size_t group = group_ids[row];
+            const Value value = values[row_at(row)];
+            column.sums[group] += value;
+            column.mins[group] = std::min(column.mins[group], value);
+            column.maxs[group] = std::max(column.maxs[group], value);
+        }
+    }
+}
+
+// Хеш-агрегация строк row_at(0), ..., row_at(row_count - 1). Группы идут в
+// порядке первого появления ключа.
+template <typename Key, typename Value, typename RowAt>
+GroupByResult<Key, Value> HashAggregate(SimpleVectorView<Key> keys,
+                                        const SimpleVector<SimpleVectorView<Value>>& columns,
+                                        size_t row_count, RowAt row_at) {
+    GroupByResult<Key, Value> result;
+    FlatIdTable<Key> table;
+    SimpleVector<size_t> group_ids(row_count);
+    for (size_t row = 0; row < row_count; ++row) {
+        const Key& key = keys[row_at(row)];
+        const size_t group = table.FindOrInsert(key);
+        if (group == result.keys.GetSize()) {
+            result.keys.PushBack(key);
+        }
+        group_ids[row] = group;
+    }
+    AggregateColumns(result, columns, group_ids, row_at);
+    return result;
+}
+
+// Плотные целые ключи: номер группы берётся прямой индексацией по key - min.
+// Группы идут по возрастанию ключа.
+template <typename Key, typename Value>
+GroupByResult<Key, Value> DenseAggregate(SimpleVectorView<Key> keys,
+                                         const SimpleVector<SimpleVectorView<Value>>& columns,
+                                         Key min_key, size_t range) {
+    auto offset_of = [min_key](Key key) {
+        return static_cast<size_t>(static_cast<uint64_t>(key) - static_cast<uint64_t>(min_key));
+    };
+    SimpleVector<size_t> group_of_offset(range, kNoGroup);
+    for (Key key : keys) {
+        group_of_offset[offset_of(key)] = 0;
+    }
+    GroupByResult<Key, Value> result;
+    for (size_t offset = 0; offset < range; ++offset) {
+        if (group_of_offset[offset] != kNoGroup) {
+            group_of_offset[offset] = result.keys.GetSize();
+            result.keys.PushBack(static_cast<Key>(static_cast<uint64_t>(min_key) + offset));
+        }
+    }
+    SimpleVector<size_t> group_ids(keys.GetSize());
+    for (size_t row = 0; row < keys.GetSize(); ++row) {
+        group_ids[row] = group_of_offset[offset_of(keys[row])];
+    }
+    AggregateColumns(result, columns, group_ids, [](size_t row) {
+        return row;
+    });
+    return result;
+}
+
+template <typename Key, typename Value>
+void AppendGroups(GroupByResult<Key, Value>& target, GroupByResult<Key, Value>&& part) {
+    for (size_t group = 0; group < part.keys.GetSize(); ++group) {
+        target.keys.PushBack(std::move(part.keys[group]));
+        target.counts.PushBack(part.counts[group]);
+        for (size_t column = 0; column < target.columns.GetSize(); ++column) {
+            target.columns[column].sums.PushBack(part.columns[column].sums[group]);
+            target.columns[column].mins.PushBack(part.columns[column].mins[group]);
+            target.columns[column].maxs.PushBack(part.columns[column].maxs[group]);
+        }
+    }
+}
+
+}  // namespace group_by_detail
+
+// Группировка строк по ключевому столбцу с подсчётом Count и
+// Sum/Min/Max по каждому столбцу значений. Столбцы (SimpleVector или
+// представления) не копируются и должны жить до вызова Run.
+template <typename Key, typename Value>
+class GroupBy {
+    static_assert(std::is_arithmetic_v<Value>, "GroupBy aggregates arithmetic values");
+
+public:
+    explicit GroupBy(SimpleVectorView<Key> keys) : keys_(keys) {
+    }
+
+    GroupBy& AddValues(SimpleVectorView<Value> values) {
+        assert(values.GetSize() == keys_.GetSize());
+        columns_.PushBack(values);
+        return *this;
+    }
+
+    // Плотные целые ключи агрегируются прямой индексацией (группы по
+    // возрастанию ключа). Иначе используется хеш-таблица: при
+    // thread_count == 1 группы идут в порядке первого появления, при
+    // thread_count > 1 строки разбиваются по хешу ключа на независимые
+    // секции, которые агрегируются параллельно, и группы идут по секциям.
+    GroupByResult<Key, Value> Run(size_t thread_count = 1) const {
+        if constexpr (std::is_integral_v<Key>) {
+            if (!keys_.IsEmpty()) {
+                const auto [min_it, max_it] = std::minmax_element(keys_.begin(), keys_.end());
+                const uint64_t range = static_cast<uint64_t>(*max_it) - static_cast<uint64_t>(*min_it) + 1;
+                if (range != 0 && range <= std::max<uint64_t>(keys_.GetSize() * group_by_detail::kDenseRangePerRow,
+                                                              group_by_detail::kDenseRangeMin)) {
+                    return group_by_detail::DenseAggregate(keys_, columns_, *min_it, static_cast<size_t>(range));
+                }
+            }
+        }
+        if (thread_count <= 1 || keys_.GetSize() < kMinRowsPerPartition * 2) {
+            return group_by_detail::HashAggregate(keys_, columns_, keys_.GetSize(), [](size_t row) {
+                return row;
+            });
+        }
+        return RunPartitioned(std::min(thread_count, keys_.GetSize() / kMinRowsPerPartition));
+    }
+
+private:
+    static constexpr size_t kMinRowsPerPartition = size_t{1} << 14;
+
+    GroupByResult<Key, Value> RunPartitioned(size_t partition_count) const {
+        const size_t row_count = keys_.GetSize();
+        auto partition_of = [partition_count](const Key& key) {
+            return static_cast<size_t>(HashKey(key) >> 32) % partition_count;
+        };
+
+        // Гистограмма секций по кускам строк, затем раскладка номеров строк.
+        SimpleVector<size_t> histogram(partition_count * partition_count);
+        ParallelFor(partition_count, partition_count, [&](size_t chunk) {
+            const auto [begin, end] = SplitRange(row_count, partition_count, chunk);
+            for (size_t row = begin; row < end; ++row) {
+                ++histogram[chunk * partition_count + partition_of(keys_[row])];
+            }
+        });
+        SimpleVector<size_t> partition_begin(partition_count + 1);
+        size_t offset = 0;
+        for (size_t partition = 0; partition < partition_count; ++partition) {
+            partition_begin[partition] = offset;
+            for (size_t chunk = 0; chunk < partition_count; ++chunk) {
+                const size_t count = histogram[chunk * partition_count + partition];
+                histogram[chunk * partition_count + partition] = offset;
+                offset += count;
+            }
+        }
+        partition_begin[partition_count] = offset;
+
+        SimpleVector<size_t> rows(row_count);
+        ParallelFor(partition_count, partition_count, [&](size_t chunk) {
+            const auto [begin, end] = SplitRange(row_count, partition_count, chunk);
+            for (size_t row = begin; row < end; ++row) {
+                rows[histogram[chunk * partition_count + partition_of(keys_[row])]++] = row;
+            }
+        });
+
+        SimpleVector<GroupByResult<Key, Value>> parts(partition_count);
+        ParallelFor(partition_count, partition_count, [&](size_t partition) {
+            const size_t* partition_rows = rows.begin() + partition_begin[partition];
+            const size_t partition_size = partition_begin[partition + 1] - partition_begin[partition];
+            parts[partition] = group_by_detail::HashAggregate(keys_, columns_, partition_size,
+                                                              [partition_rows](size_t row) {
+                return partition_rows[row];
+            });
+        });
+
+        GroupByResult<Key, Value> result = std::move(parts[0]);
+        for (size_t partition = 1; partition < partition_count; ++partition) {
+            group_by_detail::AppendGroups(result, std::move(parts[partition]));
+        }
+        return result;
+    }
+
+    SimpleVectorView<Key> keys_;
+    SimpleVector<SimpleVectorView<Value>> columns_;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include "simple_vector.h"
+
+// Финальное перемешивание MurmurHash3: растаскивает близкие ключи по всем
+// битам, чтобы и старшие, и младшие биты годились для индексации.
+inline uint64_t MixHash(uint64_t hash) noexcept {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+template <typename Key>
+uint64_t HashKey(const Key& key) {
+    return MixHash(static_cast<uint64_t>(std::hash<Key>{}(key)));
+}
+
+// Таблица с открытой адресацией и линейным пробированием, выдающая ключам
+// плотные номера 0, 1, 2, ... в порядке первой вставки.
+template <typename Key>
+class FlatIdTable {
+public:
+    FlatIdTable() : slots_(kInitialCapacity) {
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t FindOrInsert(const Key& key) {
+        const size_t mask = slots_.GetSize() - 1;
+        size_t index = static_cast<size_t>(HashKey(key)) & mask;
+        while (true) {
+            Slot& slot = slots_[index];
+            if (slot.id == kNoId) {
+                break;
+            }
+            if (slot.key == key) {
+                return slot.id;
+            }
+            index = (index + 1) & mask;
+        }
+        if ((size_ + 1) * 2 > slots_.GetSize()) {
+            Grow();
+            index = FindEmpty(key);
+        }
+        slots_[index].key = key;
+        slots_[index].id = size_;
+        return size_++;
+    }
+
+private:
+    static constexpr size_t kInitialCapacity = 1024;
+    static constexpr size_t kNoId = std::numeric_limits<size_t>::max();
+
+    struct Slot {
+        Key key{};
+        size_t id = kNoId;
+    };
+
+    size_t FindEmpty(const Key& key) const {
+        const size_t mask = slots_.GetSize() - 1;
+        size_t index = static_cast<size_t>(HashKey(key)) & mask;
+        while (slots_[index].id != kNoId) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void Grow() {
+        SimpleVector<Slot> old_slots(slots_.GetSize() * 2);
+        old_slots.swap(slots_);
+        for (Slot& slot : old_slots) {
+            if (slot.id != kNoId) {
+                Slot& target = slots_[FindEmpty(slot.key)];
+                target.key = std::move(slot.key);
+                target.id = slot.id;
+            }
+        }
+    }
+
+    SimpleVector<Slot> slots_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include "simple_vector.h"
+
+// Куча над SimpleVector. На вершине лежит наибольший по Compare элемент,
+// как в std::priority_queue. Arity задаёт число потомков узла: 4-арная куча
+// ниже и лучше ложится в кэш, чем двоичная.
+template <typename Type, typename Compare = std::less<Type>, size_t Arity = 2>
+class HeapVector {
+    static_assert(Arity >= 2, "Heap arity must be at least 2");
+
+public:
+    HeapVector() = default;
+
+    explicit HeapVector(const Compare& compare) : compare_(compare) {
+    }
+
+    size_t GetSize() const noexcept {
+        return items_.GetSize();
+    }
+
+    size_t GetCapacity() const noexcept {
+        return items_.GetCapacity();
+    }
+
+    bool IsEmpty() const noexcept {
+        return items_.IsEmpty();
+    }
+
+    void Reserve(size_t new_capacity) {
+        items_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        items_.Clear();
+    }
+
+    const Type& Top() const noexcept {
+        assert(!IsEmpty());
+        return items_[0];
+    }
+
+    void Push(const Type& item) {
+        items_.PushBack(item);
+        SiftUp(items_.GetSize() - 1);
+    }
+
+    void Push(Type&& item) {
+        items_.PushBack(std::move(item));
+        SiftUp(items_.GetSize() - 1);
+    }
+
+    void Pop() {
+        assert(!IsEmpty());
+        const size_t last = items_.GetSize() - 1;
+        if (last != 0) {
+            items_[0] = std::move(items_[last]);
+        }
+        items_.PopBack();
+        if (!IsEmpty()) {
+            SiftDown(0);
+        }
+    }
+
+    Type ExtractTop() {
+        assert(!IsEmpty());
+        Type top = std::move(items_[0]);
+        Pop();
+        return top;
+    }
+
+    // Строит кучу из готового набора элементов за O(n).
+    void Heapify(SimpleVector<Type>&& items) {
+        items_ = std::move(items);
+        const size_t size = items_.GetSize();
+        if (size < 2) {
+            return;
+        }
+        for (size_t index = (size - 2) / Arity + 1; index > 0; --index) {
+            SiftDown(index - 1);
+        }
+    }
+
+    SimpleVector<Type> ReleaseItems() noexcept {
+        return std::move(items_);
+    }
+
+    typename SimpleVector<Type>::ConstIterator begin() const noexcept {
+        return items_.begin();
+    }
+
+    typename SimpleVector<Type>::ConstIterator end() const noexcept {
+        return items_.end();
+    }
+
+private:
+    void SiftUp(size_t index) {
+        Type item = std::move(items_[index]);
+        while (index > 0) {
+            const size_t parent = (index - 1) / Arity;
+            if (!compare_(items_[parent], item)) {
+                break;
+            }
+            items_[index] = std::move(items_[parent]);
+            index = parent;
+        }
+        items_[index] = std::move(item);
+    }
+
+    void SiftDown(size_t index) {
+        const size_t size = items_.GetSize();
+        Type item = std::move(items_[index]);
+        while (true) {
+            const size_t first_child = index * Arity + 1;
+            if (first_child >= size) {
+                break;
+            }
+            const size_t last_child = std::min(first_child + Arity, size);
+            size_t best = first_child;
+            for (size_t child = first_child + 1; child < last_child; ++child) {
+                if (compare_(items_[best], items_[child])) {
+                    best = child;
+                }
+            }
+            if (!compare_(item, items_[best])) {
+                break;
+            }
+            items_[index] = std::move(items_[best]);
+            index = best;
+        }
+        items_[index] = std::move(item);
+    }
+
+    SimpleVector<Type> items_;
+    Compare compare_;
+};
+
+template <typename Type, typename Compare = std::less<Type>>
+using QuaternaryHeapVector = HeapVector<Type, Compare, 4>;
+
+// Индексированная куча: каждому элементу сопоставлен ключ из [0, key_limit),
+// по которому можно найти элемент и изменить его приоритет за O(log n).
+template <typename Type, typename Compare = std::less<Type>, size_t Arity = 2>
+class IndexedHeapVector {
+    static_assert(Arity >= 2, "Heap arity must be at least 2");
+
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    IndexedHeapVector() = default;
+
+    explicit IndexedHeapVector(size_t key_limit, const Compare& compare = Compare{})
+        : positions_(key_limit, npos), compare_(compare) {
+    }
+
+    size_t GetSize() const noexcept {
+        return keys_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return keys_.IsEmpty();
+    }
+
+    size_t GetKeyLimit() const noexcept {
+        return positions_.GetSize();
+    }
+
+    void Reserve(size_t new_capacity) {
+        items_.Reserve(new_capacity);
+        keys_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        for (size_t key : keys_) {
+            positions_[key] = npos;
+        }
+        items_.Clear();
+        keys_.Clear();
+    }
+
+    bool Contains(size_t key) const noexcept {
+        return key < positions_.GetSize() && positions_[key] != npos;
+    }
+
+    const Type& Get(size_t key) const noexcept {
+        assert(Contains(key));
+        return items_[positions_[key]];
+    }
+
+    const Type& Top() const noexcept {
+        assert(!IsEmpty());
+        return items_[0];
+    }
+
+    size_t TopKey() const noexcept {
+        assert(!IsEmpty());
+        return keys_[0];
+    }
+
+    void Push(size_t key, Type item) {
+        if (key >= positions_.GetSize()) {
+            const size_t old_limit = positions_.GetSize();
+            positions_.Resize(key + 1);
+            std::fill(positions_.begin() + old_limit, positions_.end(), npos);
+        }
+        assert(!Contains(key));
+        items_.PushBack(std::move(item));
+        keys_.PushBack(key);
+        positions_[key] = keys_.GetSize() - 1;
+        SiftUp(keys_.GetSize() - 1);
+    }
+
+    void Pop() {
+        assert(!IsEmpty());
+        EraseAt(0);
+    }
+
+    void Erase(size_t key) {
+        assert(Contains(key));
+        EraseAt(positions_[key]);
+    }
+
+    // Продвигает элемент к вершине. Для min-кучи (std::greater) это
+    // классический decrease-key.
+    void DecreaseKey(size_t key, Type item) {
+        assert(Contains(key));
+        const size_t index = positions_[key];
+        assert(!compare_(item, items_[index]));
+        items_[index] = std::move(item);
+        SiftUp(index);
+    }
+
+    // Изменяет приоритет в любую сторону.
+    void Update(size_t key, Type item) {
+        assert(Contains(key));
+        const size_t index = positions_[key];
+        const bool promote = compare_(items_[index], item);
+        items_[index] = std::move(item);
+        if (promote) {
+            SiftUp(index);
+        }
+        else {
+            SiftDown(index);
+        }
+    }
+
+private:
+    void EraseAt(size_t index) {
+        const size_t last = keys_.GetSize() - 1;
+        positions_[keys_[index]] = npos;
+        if (index != last) {
+            items_[index] = std::move(items_[last]);
+            keys_[index] = keys_[last];
+            positions_[keys_[index]] = index;
+        }
+        items_.PopBack();
+        keys_.PopBack();
+        if (index != last) {
+            if (index > 0 && compare_(items_[(index - 1) / Arity], items_[index])) {
+                SiftUp(index);
+            }
+            else {
+                SiftDown(index);
+            }
+        }
+    }
+
+    void Place(size_t index, Type&& item, size_t key) noexcept {
+        items_[index] = std::move(item);
+        keys_[index] = key;
+        positions_[key] = index;
+    }
+
+    void SiftUp(size_t index) {
+        Type item = std::move(items_[index]);
+        const size_t key = keys_[index];
+        while (index > 0) {
+            const size_t parent = (index - 1) / Arity;
+            if (!compare_(items_[parent], item)) {
+                break;
+            }
+            Place(index, std::move(items_[parent]), keys_[parent]);
+            index = parent;
+        }
+        Place(index, std::move(item), key);
+    }
+
+    void SiftDown(size_t index) {
+        const size_t size = keys_.GetSize();
+        Type item = std::move(items_[index]);
+        const size_t key = keys_[index];
+        while (true) {
+            const size_t first_child = index * Arity + 1;
+            if (first_child >= size) {
+                break;
+            }
+            const size_t last_child = std::min(first_child + Arity, size);
+            size_t best = first_child;
+            for (size_t child = first_child + 1; child < last_child; ++child) {
+                if (compare_(items_[best], items_[child])) {
+                    best = child;
+                }
+            }
+            if (!compare_(item, items_[best])) {
+                break;
+            }
+            Place(index, std::move(items_[best]), keys_[best]);
+            index = best;
+        }
+        Place(index, std::move(item), key);
+    }
+
+    SimpleVector<Type> items_;
+    SimpleVector<size_t> keys_;
+    SimpleVector<size_t> positions_;
+    Compare compare_;
+};
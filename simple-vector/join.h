@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+#include "hash_utils.h"
+#include "parallel.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+// Пары индексов совпавших строк: left_keys[left[i]] == right_keys[right[i]].
+struct JoinResult {
+    size_t GetSize() const noexcept {
+        return left.GetSize();
+    }
+
+    SimpleVector<size_t> left;
+    SimpleVector<size_t> right;
+};
+
+namespace join_detail {
+
+constexpr size_t kNoRow = std::numeric_limits<size_t>::max();
+
+// Секция строящей стороны должна помещаться в L2 вместе со своей таблицей.
+constexpr size_t kBuildRowsPerPartition = size_t{1} << 14;
+constexpr unsigned kMaxPartitionBits = 10;
+
+// Зондирующая сторона нарезается на куски не мельче этого.
+constexpr size_t kProbeRowsPerTask = size_t{1} << 14;
+
+// Сторона соединения, разложенная по секциям. Без разбиения (bits == 0)
+// keys ссылается на исходные ключи, rows пуст, и строка равна позиции.
+struct Partitioned {
+    size_t RowAt(size_t position) const noexcept {
+        return rows.IsEmpty() ? position : rows[position];
+    }
+
+    SimpleVectorView<uint64_t> keys;
+    SimpleVector<uint64_t> storage;
+    SimpleVector<size_t> rows;
+    // Секция p занимает [begin[p], begin[p + 1]).
+    SimpleVector<size_t> begin;
+};
+
+inline size_t PartitionOf(uint64_t key, unsigned bits) noexcept {
+    return bits == 0 ? 0 : static_cast<size_t>(MixHash(key) >> (64 - bits));
+}
+
+// Раскладывает ключи по 2^bits секциям по старшим битам хеша. При bits == 0
+// секция одна, и ключи не копируются.
+inline Partitioned Partition(SimpleVectorView<uint64_t> keys, unsigned bits, size_t thread_count) {
+    const size_t size = keys.GetSize();
+    Partitioned result;
+    if (bits == 0) {
+        result.keys = keys;
+        result.begin = SimpleVector<size_t>{0, size};
+        return result;
+    }
+    const size_t partition_count = size_t{1} << bits;
+    const size_t chunk_count = std::max<size_t>(1, std::min(thread_count, size / kBuildRowsPerPartition));
+
+    SimpleVector<size_t> histogram(chunk_count * partition_count);
+    ParallelFor(chunk_count, chunk_count, [&](size_t chunk) {
+        const auto [begin, end] = SplitRange(size, chunk_count, chunk);
+        size_t* counts = histogram.begin() + chunk * partition_count;
+        for (size_t row = begin; row < end; ++row) {
+            ++counts[PartitionOf(keys[row], bits)];
+        }
+    });
+
+    result.begin = SimpleVector<size_t>(partition_count + 1);
+    size_t offset = 0;
+    for (size_t partition = 0; partition < partition_count; ++partition) {
+        result.begin[partition] = offset;
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            size_t& cell = histogram[chunk * partition_count + partition];
+            const size_t count = cell;
+            cell = offset;
+            offset += count;
+        }
+    }
+    result.begin[partition_count] = offset;
+
+    result.storage = SimpleVector<uint64_t>(size);
+    result.rows = SimpleVector<size_t>(size);
+    ParallelFor(chunk_count, chunk_count, [&](size_t chunk) {
+        const auto [begin, end] = SplitRange(size, chunk_count, chunk);
+        size_t* positions = histogram.begin() + chunk * partition_count;
+        for (size_t row = begin; row < end; ++row) {
+            const size_t position = positions[PartitionOf(keys[row], bits)]++;
+            result.storage[position] = keys[row];
+            result.rows[position] = row;
+        }
+    });
+    result.keys = result.storage;
+    return result;
+}
+
+// Цепочечная хеш-таблица над одной секцией строящей стороны.
+struct PartitionTable {
+    size_t build_begin = 0;
+    size_t mask = 0;
+    SimpleVector<size_t> heads;
+    SimpleVector<size_t> next;
+};
+
+inline PartitionTable BuildTable(const Partitioned& build, size_t partition) {
+    PartitionTable table;
+    table.build_begin = build.begin[partition];
+    const size_t build_size = build.begin[partition + 1] - table.build_begin;
+    if (build_size == 0) {
+        return table;
+    }
+
+    size_t bucket_count = 1;
+    while (bucket_count < build_size) {
+        bucket_count *= 2;
+    }
+    table.mask = bucket_count - 1;
+    table.heads = SimpleVector<size_t>(bucket_count, kNoRow);
+    table.next = SimpleVector<size_t>(build_size);
+    const uint64_t* build_keys = build.keys.begin() + table.build_begin;
+    for (size_t index = build_size; index > 0; --index) {
+        const size_t bucket = static_cast<size_t>(MixHash(build_keys[index - 1])) & table.mask;
+        table.next[index - 1] = table.heads[bucket];
+        table.heads[bucket] = index - 1;
+    }
+    return table;
+}
+
+// Зондирует таблицу секции позициями [probe_begin, probe_end) другой стороны.
+inline void ProbeTable(const Partitioned& build, const PartitionTable& table, const Partitioned& probe,
+                       size_t probe_begin, size_t probe_end, JoinResult& output) {
+    if (table.heads.IsEmpty()) {
+        return;
+    }
+    const uint64_t* build_keys = build.keys.begin() + table.build_begin;
+    for (size_t position = probe_begin; position < probe_end; ++position) {
+        const uint64_t key = probe.keys[position];
+        for (size_t index = table.heads[static_cast<size_t>(MixHash(key)) & table.mask]; index != kNoRow;
+             index = table.next[index]) {
+            if (build_keys[index] == key) {
+                output.left.PushBack(build.RowAt(table.build_begin + index));
+                output.right.PushBack(probe.RowAt(position));
+            }
+        }
+    }
+}
+
+inline void AppendPairs(JoinResult& target, const JoinResult& part) {
+    target.left.Reserve(target.left.GetSize() + part.GetSize());
+    target.right.Reserve(target.right.GetSize() + part.GetSize());
+    for (size_t i = 0; i < part.GetSize(); ++i) {
+        target.left.PushBack(part.left[i]);
+        target.right.PushBack(part.right[i]);
+    }
+}
+
+}  // namespace join_detail
+
+// Хеш-соединение: таблица строится по left, по ней зондируется right. Обе
+// стороны раскладываются по секциям старшими битами хеша так, чтобы таблица
+// секции жила в кэше; секции соединяются параллельно. Если секций меньше,
+// чем потоков, зондирование каждой секции дополнительно делится между
+// потоками. Порядок пар не задан.
+inline JoinResult HashJoin(SimpleVectorView<uint64_t> left, SimpleVectorView<uint64_t> right, size_t thread_count = 1) {
+    thread_count = std::max<size_t>(thread_count, 1);
+    unsigned bits = 0;
+    while (bits < join_detail::kMaxPartitionBits && (left.GetSize() >> bits) > join_detail::kBuildRowsPerPartition) {
+        ++bits;
+    }
+    const join_detail::Partitioned build = join_detail::Partition(left, bits, thread_count);
+    const join_detail::Partitioned probe = join_detail::Partition(right, bits, thread_count);
+
+    const size_t partition_count = size_t{1} << bits;
+    SimpleVector<join_detail::PartitionTable> tables(partition_count);
+    ParallelFor(partition_count, thread_count, [&](size_t partition) {
+        tables[partition] = join_detail::BuildTable(build, partition);
+    });
+
+    const size_t slice_count = (thread_count + partition_count - 1) / partition_count;
+    SimpleVector<JoinResult> parts(partition_count * slice_count);
+    ParallelFor(parts.GetSize(), thread_count, [&](size_t task) {
+        const size_t partition = task / slice_count;
+        const size_t probe_begin = probe.begin[partition];
+        const size_t probe_size = probe.begin[partition + 1] - probe_begin;
+        const size_t slices = std::max<size_t>(1, std::min(slice_count, probe_size / join_detail::kProbeRowsPerTask));
+        const size_t slice = task % slice_count;
+        if (slice >= slices) {
+            return;
+        }
+        const auto [begin, end] = SplitRange(probe_size, slices, slice);
+        join_detail::ProbeTable(build, tables[partition], probe, probe_begin + begin, probe_begin + end, parts[task]);
+    });
+
+    JoinResult result = std::move(parts[0]);
+    for (size_t task = 1; task < parts.GetSize(); ++task) {
+        join_detail::AppendPairs(result, parts[task]);
+    }
+    return result;
+}
+
+inline JoinResult HashJoin(const SimpleVector<uint64_t>& left, const SimpleVector<uint64_t>& right,
+                           size_t thread_count = 1) {
+    return HashJoin(SimpleVectorView<uint64_t>(left), SimpleVectorView<uint64_t>(right), thread_count);
+}
+
+// Соединение слиянием для отсортированных по возрастанию входов. Для серий
+// равных ключей выдаётся их декартово произведение; пары упорядочены по
+// (left, right).
+inline JoinResult MergeJoin(SimpleVectorView<uint64_t> left, SimpleVectorView<uint64_t> right) {
+    assert(std::is_sorted(left.begin(), left.end()));
+    assert(std::is_sorted(right.begin(), right.end()));
+    JoinResult result;
+    size_t left_index = 0;
+    size_t right_index = 0;
+    while (left_index < left.GetSize() && right_index < right.GetSize()) {
+        if (left[left_index] < right[right_index]) {
+            ++left_index;
+        }
+        else if (right[right_index] < left[left_index]) {
+            ++right_index;
+        }
+        else {
+            const uint64_t key = left[left_index];
+            size_t right_end = right_index;
+            while (right_end < right.GetSize() && right[right_end] == key) {
+                ++right_end;
+            }
+            for (; left_index < left.GetSize() && left[left_index] == key; ++left_index) {
+                for (size_t index = right_index; index < right_end; ++index) {
+                    result.left.PushBack(left_index);
+                    result.right.PushBack(index);
+                }
+            }
+            right_index = right_end;
+        }
+    }
+    return result;
+}
+
+inline JoinResult MergeJoin(const SimpleVector<uint64_t>& left, const SimpleVector<uint64_t>& right) {
+    return MergeJoin(SimpleVectorView<uint64_t>(left), SimpleVectorView<uint64_t>(right));
+}
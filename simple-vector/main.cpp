@@ -1,9 +1,38 @@
 #include "simple_vector.h"
+#include "heap_vector.h"
+#include "slot_map.h"
+#include "filter.h"
+#include "permutation.h"
+#include "scan.h"
+#include "group_by.h"
+#include "join.h"
+#include "top_k.h"
+#include "radix_sort.h"
+#include "unique.h"
+#include "merge.h"
+#include "range_query.h"
+#include "sparse_table.h"
+#include "gap_vector.h"
+#include "tree_vector.h"
+#include "persistent_vector.h"
+#include "cow_vector.h"
+#include "shared_slice.h"
+#include "simple_vector_view.h"
+#include "serialization.h"
+#include "mmap_vector.h"
+#include "chunked_stream.h"
+#include "async_io.h"
+#include "compression.h"
 
 #include <cassert>
+#include <cstdlib>
 #include <iostream>
+#include <map>
+#include <set>
 #include <numeric>
+#include <random>
 #include <string>
+#include <thread>
 
 using namespace std;
 
@@ -150,6 +179,1626 @@ void TestNoncopiableErase() {
     cout << "Done!"s << endl << endl;
 }
 
+void TestHeapVector() {
+    cout << "Test heap vector"s << endl;
+    HeapVector<int> heap;
+    for (int i : {5, 1, 9, 3, 7, 3}) {
+        heap.Push(i);
+    }
+    assert(heap.Top() == 9);
+    int expected[] = {9, 7, 5, 3, 3, 1};
+    for (int value : expected) {
+        assert(heap.Top() == value);
+        heap.Pop();
+    }
+    assert(heap.IsEmpty());
+
+    QuaternaryHeapVector<int, greater<int>> min_heap;
+    min_heap.Heapify(GenerateVector(100));
+    for (int i = 1; i <= 100; ++i) {
+        assert(min_heap.ExtractTop() == i);
+    }
+
+    auto x_less = [](const X& lhs, const X& rhs) {
+        return lhs.GetX() < rhs.GetX();
+    };
+    HeapVector<X, decltype(x_less)> noncopiable(x_less);
+    for (size_t i = 0; i < 5; ++i) {
+        noncopiable.Push(X(i));
+    }
+    assert(noncopiable.GetSize() == 5);
+    assert(noncopiable.ExtractTop().GetX() == 4);
+    assert(noncopiable.Top().GetX() == 3);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestIndexedHeapVector() {
+    cout << "Test indexed heap vector"s << endl;
+    IndexedHeapVector<int, greater<int>, 4> heap(10);
+    for (size_t key = 0; key < 10; ++key) {
+        heap.Push(key, static_cast<int>(key) * 10 + 10);
+    }
+    assert(heap.TopKey() == 0);
+    heap.DecreaseKey(7, 5);
+    assert(heap.TopKey() == 7 && heap.Top() == 5);
+    heap.Update(7, 1000);
+    assert(heap.TopKey() == 0);
+    heap.Erase(0);
+    assert(!heap.Contains(0));
+    heap.Push(12, 0);
+    assert(heap.TopKey() == 12);
+    heap.Pop();
+    int previous = 0;
+    while (!heap.IsEmpty()) {
+        assert(heap.Top() >= previous);
+        previous = heap.Top();
+        heap.Pop();
+    }
+    assert(previous == 1000);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestSlotMap() {
+    cout << "Test slot map"s << endl;
+    SlotMap<string> map;
+    SlotHandle a = map.Insert("a"s);
+    SlotHandle b = map.Insert("b"s);
+    SlotHandle c = map.Insert("c"s);
+    assert(map.GetSize() == 3);
+
+    assert(map.Erase(a));
+    assert(!map.Erase(a));
+    assert(!map.Contains(a));
+    assert(map.Find(a) == nullptr);
+    assert(map[b] == "b"s && map[c] == "c"s);
+    assert(map.GetSize() == 2);
+
+    SlotHandle d = map.Insert("d"s);
+    assert(d.index == a.index && d != a);
+    assert(map[d] == "d"s);
+
+    string joined;
+    for (const string& value : map) {
+        joined += value;
+    }
+    assert(joined.size() == 3);
+
+    map.Clear();
+    assert(map.IsEmpty() && !map.Contains(b) && !map.Contains(d));
+    try {
+        map.At(b);
+        assert(false);
+    }
+    catch (const out_of_range&) {
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestUnorderedErase() {
+    cout << "Test unordered erase"s << endl;
+    SimpleVector<int> v = GenerateVector(5);
+    auto it = v.UnorderedErase(v.begin() + 1);
+    assert(*it == 5);
+    assert((v == SimpleVector<int>{1, 5, 3, 4}));
+    v.UnorderedErase(v.end() - 1);
+    assert((v == SimpleVector<int>{1, 5, 3}));
+
+    SimpleVector<X> noncopiable;
+    for (size_t i = 0; i < 3; ++i) {
+        noncopiable.PushBack(X(i));
+    }
+    noncopiable.UnorderedErase(noncopiable.begin());
+    assert(noncopiable.GetSize() == 2 && noncopiable[0].GetX() == 2);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestEraseIfAndIndices() {
+    cout << "Test EraseIf and EraseIndices"s << endl;
+    SimpleVector<int> v = GenerateVector(10);
+    assert(v.EraseIf([](int value) { return value % 3 == 0; }) == 3);
+    assert((v == SimpleVector<int>{1, 2, 4, 5, 7, 8, 10}));
+
+    assert(v.EraseIndices({0, 3, 4, 6}) == 4);
+    assert((v == SimpleVector<int>{2, 4, 8}));
+    assert(v.EraseIndices({}) == 0);
+    assert(v.GetSize() == 3);
+    cout << "Done!"s << endl << endl;
+}
+
+template <typename Type>
+void CheckFilter(const SimpleVector<Type>& values, Type operand) {
+    for (CompareOp op : {CompareOp::Less, CompareOp::LessEqual, CompareOp::Greater,
+                         CompareOp::GreaterEqual, CompareOp::Equal, CompareOp::NotEqual}) {
+        SimpleVector<Type> expected;
+        SimpleVector<uint32_t> expected_selection;
+        for (size_t i = 0; i < values.GetSize(); ++i) {
+            const Type value = values[i];
+            bool keep = false;
+            switch (op) {
+            case CompareOp::Less: keep = value < operand; break;
+            case CompareOp::LessEqual: keep = value <= operand; break;
+            case CompareOp::Greater: keep = value > operand; break;
+            case CompareOp::GreaterEqual: keep = value >= operand; break;
+            case CompareOp::Equal: keep = value == operand; break;
+            case CompareOp::NotEqual: keep = value != operand; break;
+            }
+            if (keep) {
+                expected.PushBack(value);
+                expected_selection.PushBack(static_cast<uint32_t>(i));
+            }
+        }
+        assert(Filter(values, op, operand) == expected);
+        assert(Compact(values, FilterMask(values, op, operand)) == expected);
+        assert(FilterSelection(values, op, operand) == expected_selection);
+    }
+}
+
+void TestFilter() {
+    cout << "Test filter"s << endl;
+    const size_t size = 1003;
+    SimpleVector<int> ints(size);
+    SimpleVector<float> floats(size);
+    SimpleVector<int64_t> longs(size);
+    for (size_t i = 0; i < size; ++i) {
+        ints[i] = static_cast<int>((i * 7919) % 101) - 50;
+        floats[i] = static_cast<float>(ints[i]) / 4.0f;
+        longs[i] = static_cast<int64_t>(ints[i]) * (int64_t{1} << 33);
+    }
+    CheckFilter(ints, 0);
+    CheckFilter(ints, -50);
+    CheckFilter(floats, 2.5f);
+    CheckFilter(longs, int64_t{7} << 33);
+    CheckFilter(SimpleVector<double>{}, 1.0);
+
+    // Биты маски за концом вектора не читают чужую память
+    SimpleVector<uint64_t> mask = FilterMask(ints, CompareOp::Greater, 0);
+    mask[mask.GetSize() - 1] |= ~uint64_t{0} << (size % 64);
+    mask.PushBack(~uint64_t{0});
+    assert(Compact(ints, mask) == Filter(ints, CompareOp::Greater, 0));
+    const SimpleVectorView<int> first_word = SimpleVectorView<int>(ints).Subview(0, 64);
+    assert(Compact(first_word, mask) == Filter(first_word, CompareOp::Greater, 0));
+    cout << "Done!"s << endl << endl;
+}
+
+void TestGatherScatterPermutation() {
+    cout << "Test gather, scatter and permutation"s << endl;
+    const size_t size = 1000;
+    SimpleVector<int> values = GenerateVector(size);
+    SimpleVector<uint32_t> indices(size);
+    for (size_t i = 0; i < size; ++i) {
+        indices[i] = static_cast<uint32_t>((i * 7) % size);
+    }
+
+    SimpleVector<int> gathered = Gather(values, indices);
+    for (size_t i = 0; i < size; ++i) {
+        assert(gathered[i] == values[indices[i]]);
+    }
+
+    SimpleVector<int> scattered(size);
+    Scatter(gathered, indices, scattered);
+    assert(scattered == values);
+
+    SimpleVector<string> words{"c"s, "a"s, "d"s, "b"s};
+    ApplyPermutation(words, SimpleVector<size_t>{1, 3, 0, 2});
+    assert((words == SimpleVector<string>{"a"s, "b"s, "c"s, "d"s}));
+
+    ApplyPermutation(values, indices);
+    assert(values == gathered);
+
+    SimpleVector<X> noncopiable;
+    for (size_t i = 0; i < 3; ++i) {
+        noncopiable.PushBack(X(i));
+    }
+    ApplyPermutation(noncopiable, SimpleVector<int>{2, 0, 1});
+    assert(noncopiable[0].GetX() == 2 && noncopiable[1].GetX() == 0 && noncopiable[2].GetX() == 1);
+
+    // Не перестановка отвергается до того, как values изменится
+    for (const SimpleVector<int>& broken : {SimpleVector<int>{2, 0, 2}, SimpleVector<int>{1, 3, 0},
+                                            SimpleVector<int>{0, -1, 1}, SimpleVector<int>{0, 1}}) {
+        try {
+            ApplyPermutation(noncopiable, broken);
+            assert(false);
+        }
+        catch (const invalid_argument&) {
+        }
+        assert(noncopiable[0].GetX() == 2 && noncopiable[1].GetX() == 0 && noncopiable[2].GetX() == 1);
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+template <typename Type>
+void CheckScans(size_t size, size_t thread_count) {
+    SimpleVector<Type> values(size);
+    for (size_t i = 0; i < size; ++i) {
+        values[i] = static_cast<Type>(i % 7);
+    }
+    SimpleVector<Type> inclusive = values;
+    SimpleVector<Type> exclusive = values;
+    const Type inclusive_total = InclusiveScan(inclusive, thread_count);
+    const Type exclusive_total = ExclusiveScan(exclusive, thread_count);
+    Type sum{};
+    for (size_t i = 0; i < size; ++i) {
+        assert(exclusive[i] == sum);
+        sum += values[i];
+        assert(inclusive[i] == sum);
+    }
+    assert(inclusive_total == sum && exclusive_total == sum);
+
+    SimpleVector<bool> heads(size);
+    for (size_t i = 0; i < size; i += 1000) {
+        heads[i] = true;
+    }
+    SimpleVector<Type> segmented = values;
+    SegmentedInclusiveScan(segmented, heads, thread_count);
+    sum = Type{};
+    for (size_t i = 0; i < size; ++i) {
+        sum = values[i] + (heads[i] ? Type{} : sum);
+        assert(segmented[i] == sum);
+    }
+}
+
+void TestScans() {
+    cout << "Test scans"s << endl;
+    for (size_t size : {0, 1, 7, 8, 9, 1001}) {
+        CheckScans<int>(size, 1);
+        CheckScans<int64_t>(size, 1);
+        CheckScans<float>(size, 1);
+        CheckScans<double>(size, 1);
+    }
+    CheckScans<int>(300007, 4);
+    CheckScans<int64_t>(300007, 3);
+    CheckScans<float>(200003, 2);
+    cout << "Done!"s << endl << endl;
+}
+
+template <typename Key>
+void CheckGroupBy(const SimpleVector<Key>& keys, size_t thread_count) {
+    const size_t size = keys.GetSize();
+    SimpleVector<int64_t> first(size);
+    SimpleVector<int64_t> second(size);
+    for (size_t i = 0; i < size; ++i) {
+        first[i] = static_cast<int64_t>(i % 13) - 6;
+        second[i] = static_cast<int64_t>(i);
+    }
+    struct Expected {
+        size_t count = 0;
+        int64_t sum = 0;
+        int64_t min = numeric_limits<int64_t>::max();
+        int64_t max = numeric_limits<int64_t>::lowest();
+        int64_t second_sum = 0;
+    };
+    map<Key, Expected> expected;
+    for (size_t i = 0; i < size; ++i) {
+        Expected& group = expected[keys[i]];
+        ++group.count;
+        group.sum += first[i];
+        group.min = min(group.min, first[i]);
+        group.max = max(group.max, first[i]);
+        group.second_sum += second[i];
+    }
+
+    GroupByResult<Key, int64_t> result = GroupBy<Key, int64_t>(keys).AddValues(first).AddValues(second).Run(thread_count);
+    assert(result.GetGroupCount() == expected.size());
+    assert(result.columns.GetSize() == 2);
+    for (size_t group = 0; group < result.GetGroupCount(); ++group) {
+        const Expected& group_expected = expected.at(result.keys[group]);
+        assert(result.counts[group] == group_expected.count);
+        assert(result.columns[0].sums[group] == group_expected.sum);
+        assert(result.columns[0].mins[group] == group_expected.min);
+        assert(result.columns[0].maxs[group] == group_expected.max);
+        assert(result.columns[1].sums[group] == group_expected.second_sum);
+    }
+}
+
+void TestGroupBy() {
+    cout << "Test group by"s << endl;
+    const size_t size = 100000;
+    SimpleVector<int> dense_keys(size);
+    SimpleVector<uint64_t> sparse_keys(size);
+    SimpleVector<string> string_keys(size);
+    for (size_t i = 0; i < size; ++i) {
+        dense_keys[i] = static_cast<int>((i * 31) % 1000) - 500;
+        sparse_keys[i] = ((i * 7919) % 5003) * 0x9E3779B97F4A7C15ULL;
+        string_keys[i] = to_string(i % 777);
+    }
+    CheckGroupBy(dense_keys, 1);
+    CheckGroupBy(sparse_keys, 1);
+    CheckGroupBy(sparse_keys, 4);
+    CheckGroupBy(string_keys, 3);
+    CheckGroupBy(SimpleVector<uint64_t>{}, 2);
+
+    SimpleVector<int> keys{3, 1, 3};
+    GroupByResult<int, int> counts_only = GroupBy<int, int>(keys).Run();
+    assert((counts_only.keys == SimpleVector<int>{1, 3}));
+    assert((counts_only.counts == SimpleVector<size_t>{1, 2}));
+
+    // Разреженные ключи крошечного входа идут через хеш-таблицу (порядок
+    // первого появления), а не через плотную таблицу на весь диапазон
+    SimpleVector<int> wide_keys{5000, 1, 5000};
+    GroupByResult<int, int> wide = GroupBy<int, int>(wide_keys).Run();
+    assert((wide.keys == SimpleVector<int>{5000, 1}));
+    assert((wide.counts == SimpleVector<size_t>{2, 1}));
+    cout << "Done!"s << endl << endl;
+}
+
+set<pair<size_t, size_t>> JoinPairs(const JoinResult& result) {
+    assert(result.left.GetSize() == result.right.GetSize());
+    set<pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < result.GetSize(); ++i) {
+        pairs.insert({result.left[i], result.right[i]});
+    }
+    assert(pairs.size() == result.GetSize());
+    return pairs;
+}
+
+void TestJoins() {
+    cout << "Test joins"s << endl;
+    const size_t left_size = 70000;
+    const size_t right_size = 50000;
+    SimpleVector<uint64_t> left(left_size);
+    SimpleVector<uint64_t> right(right_size);
+    for (size_t i = 0; i < left_size; ++i) {
+        left[i] = (i * 7919) % 60000;
+    }
+    for (size_t i = 0; i < right_size; ++i) {
+        right[i] = (i * 104729) % 90000;
+    }
+    multimap<uint64_t, size_t> left_rows;
+    for (size_t i = 0; i < left_size; ++i) {
+        left_rows.insert({left[i], i});
+    }
+    set<pair<size_t, size_t>> expected;
+    for (size_t i = 0; i < right_size; ++i) {
+        auto [first, last] = left_rows.equal_range(right[i]);
+        for (auto it = first; it != last; ++it) {
+            expected.insert({it->second, i});
+        }
+    }
+    assert(JoinPairs(HashJoin(left, right)) == expected);
+    assert(JoinPairs(HashJoin(left, right, 4)) == expected);
+
+    // Маленькая строящая сторона даёт одну секцию; её зондирование делится
+    // между потоками
+    SimpleVector<uint64_t> small_left{5, 17, 17, 90001};
+    SimpleVector<uint64_t> large_right(100000);
+    set<pair<size_t, size_t>> small_expected;
+    for (size_t i = 0; i < large_right.GetSize(); ++i) {
+        large_right[i] = i % 20;
+        if (large_right[i] == 5) {
+            small_expected.insert({0, i});
+        }
+        else if (large_right[i] == 17) {
+            small_expected.insert({1, i});
+            small_expected.insert({2, i});
+        }
+    }
+    for (size_t threads : {1, 3, 8}) {
+        const JoinResult small = HashJoin(small_left, large_right, threads);
+        assert(small.GetSize() == small_expected.size());
+        assert(JoinPairs(small) == small_expected);
+    }
+
+    SimpleVector<uint64_t> sorted_left{1, 2, 2, 4, 7};
+    SimpleVector<uint64_t> sorted_right{2, 2, 3, 4, 8};
+    set<pair<size_t, size_t>> merge_expected{{1, 0}, {1, 1}, {2, 0}, {2, 1}, {3, 3}};
+    assert(JoinPairs(MergeJoin(sorted_left, sorted_right)) == merge_expected);
+    assert(JoinPairs(HashJoin(sorted_left, sorted_right)) == merge_expected);
+    assert(MergeJoin(sorted_left, SimpleVector<uint64_t>{}).GetSize() == 0);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestTopK() {
+    cout << "Test top k"s << endl;
+    const size_t size = 200000;
+    SimpleVector<int> values(size);
+    for (size_t i = 0; i < size; ++i) {
+        values[i] = static_cast<int>((i * 7919) % 100003);
+    }
+    SimpleVector<int> sorted = values;
+    sort(sorted.begin(), sorted.end());
+
+    for (size_t k : {0, 1, 100, 5000, 150000}) {
+        for (size_t thread_count : {1, 4}) {
+            SimpleVector<int> top = TopK(values, k, thread_count);
+            SimpleVector<int> bottom = BottomK(values, k, thread_count);
+            assert(top.GetSize() == k && bottom.GetSize() == k);
+            for (size_t i = 0; i < k; ++i) {
+                assert(top[i] == sorted[size - 1 - i]);
+                assert(bottom[i] == sorted[i]);
+            }
+        }
+    }
+
+    SimpleVector<int> ties{5, 1, 5, 3, 5};
+    assert((TopKIndices(ties, 2) == SimpleVector<size_t>{0, 2}));
+    assert((BottomKIndices(ties, 2) == SimpleVector<size_t>{1, 3}));
+    assert(TopK(ties, 10).GetSize() == ties.GetSize());
+    cout << "Done!"s << endl << endl;
+}
+
+void TestRadixSort() {
+    cout << "Test radix sort"s << endl;
+    const size_t size = 10000;
+    SimpleVector<int64_t> values(size);
+    for (size_t i = 0; i < size; ++i) {
+        values[i] = static_cast<int64_t>((i * 7919) % 1009) * ((i % 2 == 0) ? 1 : -1000003);
+    }
+    SimpleVector<size_t> order = RadixSortIndices(values);
+    for (size_t i = 1; i < size; ++i) {
+        assert(values[order[i - 1]] < values[order[i]]
+               || (values[order[i - 1]] == values[order[i]] && order[i - 1] < order[i]));
+    }
+    SimpleVector<int64_t> sorted = values;
+    RadixSort(sorted);
+    sort(values.begin(), values.end());
+    assert(sorted == values);
+
+    SimpleVector<uint8_t> bytes{200, 3, 255, 0, 3};
+    RadixSort(bytes);
+    assert((bytes == SimpleVector<uint8_t>{0, 3, 3, 200, 255}));
+    cout << "Done!"s << endl << endl;
+}
+
+void TestUnique() {
+    cout << "Test unique"s << endl;
+    SimpleVector<int> values{5, -1, 5, 3, -1, 7, 3};
+    assert((Unique(values) == SimpleVector<int>{-1, 3, 5, 7}));
+    assert((Unique(values, UniqueStrategy::Hash) == SimpleVector<int>{5, -1, 3, 7}));
+    assert((DistinctIndices(values) == SimpleVector<size_t>{1, 3, 0, 5}));
+    assert((DistinctIndices(values, UniqueStrategy::Hash) == SimpleVector<size_t>{0, 1, 3, 5}));
+
+    SimpleVector<string> words{"b"s, "a"s, "b"s, "c"s, "a"s};
+    assert((Unique(words) == SimpleVector<string>{"b"s, "a"s, "c"s}));
+    assert((Unique(words, UniqueStrategy::Sort) == SimpleVector<string>{"a"s, "b"s, "c"s}));
+    assert((DistinctIndices(words, UniqueStrategy::Sort) == SimpleVector<size_t>{1, 0, 3}));
+
+    assert(UniqueInPlace(values) == 3);
+    assert((values == SimpleVector<int>{5, -1, 3, 7}));
+
+    const size_t size = 50000;
+    SimpleVector<uint64_t> ids(size);
+    for (size_t i = 0; i < size; ++i) {
+        ids[i] = (i * 7919) % 3001;
+    }
+    assert(Unique(ids).GetSize() == 3001);
+    assert(Unique(ids, UniqueStrategy::Hash).GetSize() == 3001);
+    assert(UniqueInPlace(ids) == size - 3001);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestKWayMerge() {
+    cout << "Test k-way merge"s << endl;
+    for (size_t run_count : {1, 2, 5, 37}) {
+        SimpleVector<SimpleVector<pair<int, size_t>>> runs(run_count);
+        SimpleVector<pair<int, size_t>> expected;
+        for (size_t run = 0; run < run_count; ++run) {
+            const size_t run_size = (run * 7919) % 20000 + (run % 3 == 0 ? 0 : 1000);
+            for (size_t i = 0; i < run_size; ++i) {
+                runs[run].PushBack({static_cast<int>((i * (run + 1)) / 3), run});
+            }
+            for (const auto& item : runs[run]) {
+                expected.PushBack(item);
+            }
+        }
+        stable_sort(expected.begin(), expected.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first < rhs.first;
+        });
+        auto by_value = [](const pair<int, size_t>& lhs, const pair<int, size_t>& rhs) {
+            return lhs.first < rhs.first;
+        };
+        for (size_t thread_count : {1, 4}) {
+            SimpleVector<pair<int, size_t>> output;
+            output.Reserve(expected.GetSize());
+            KWayMerge(runs, output, thread_count, by_value);
+            assert(output == expected);
+        }
+    }
+
+    SimpleVector<SimpleVector<int>> runs{{1, 4, 9}, {}, {2, 3, 10}, {0}};
+    assert((KWayMerge(runs) == SimpleVector<int>{0, 1, 2, 3, 4, 9, 10}));
+    assert(KWayMerge(SimpleVector<SimpleVector<int>>{}).IsEmpty());
+    cout << "Done!"s << endl << endl;
+}
+
+struct ConcatMonoid {
+    string Identity() const {
+        return ""s;
+    }
+
+    string operator()(const string& lhs, const string& rhs) const {
+        return lhs + rhs;
+    }
+};
+
+void TestRangeQueries() {
+    cout << "Test range queries"s << endl;
+    const size_t size = 1000;
+    SimpleVector<int64_t> values(size);
+    for (size_t i = 0; i < size; ++i) {
+        values[i] = static_cast<int64_t>((i * 7919) % 1013) - 500;
+    }
+    FenwickTree<int64_t> sums(values);
+    MinSegmentTree<int64_t> mins(values);
+    MaxSegmentTree<int64_t> maxs(values);
+    for (size_t step = 0; step < 2000; ++step) {
+        const size_t index = (step * 31) % size;
+        const int64_t value = static_cast<int64_t>((step * 104729) % 2003) - 1000;
+        values[index] = value;
+        sums.Set(index, value);
+        mins.Set(index, value);
+        maxs.Set(index, value);
+
+        const size_t begin = (step * 17) % size;
+        const size_t end = begin + (step * 13) % (size - begin + 1);
+        int64_t sum = 0;
+        int64_t min_value = numeric_limits<int64_t>::max();
+        int64_t max_value = numeric_limits<int64_t>::lowest();
+        for (size_t i = begin; i < end; ++i) {
+            sum += values[i];
+            min_value = min(min_value, values[i]);
+            max_value = max(max_value, values[i]);
+        }
+        assert(sums.RangeSum(begin, end) == sum);
+        assert(mins.Query(begin, end) == min_value);
+        assert(maxs.Query(begin, end) == max_value);
+    }
+
+    SegmentTree<string, ConcatMonoid> text(SimpleVector<string>{"a"s, "b"s, "c"s, "d"s, "e"s});
+    assert(text.Query(1, 4) == "bcd"s);
+    text.Set(2, "X"s);
+    assert(text.Query(0, 5) == "abXde"s);
+    assert(text.Query(3, 3).empty());
+    cout << "Done!"s << endl << endl;
+}
+
+static_assert(std::is_constructible_v<MinSparseTable<int>, const SimpleVector<int>&>);
+static_assert(!std::is_constructible_v<MinSparseTable<int>, SimpleVector<int>&&>);
+static_assert(!std::is_constructible_v<MaxSparseTable<int>, SimpleVector<int>, size_t>);
+
+void TestSparseTable() {
+    cout << "Test sparse table"s << endl;
+    for (size_t size : {1, 2, 3, 100, 70000}) {
+        SimpleVector<int> values(size);
+        for (size_t i = 0; i < size; ++i) {
+            values[i] = static_cast<int>((i * 7919) % 211);
+        }
+        MinSparseTable<int> mins(values, 4);
+        MaxSparseTable<int> maxs(values);
+        for (size_t step = 0; step < 500; ++step) {
+            const size_t begin = (step * 104729) % size;
+            const size_t end = begin + 1 + (step * step) % (size - begin);
+            size_t min_index = begin;
+            size_t max_index = begin;
+            for (size_t i = begin; i < end && i < begin + 1000; ++i) {
+                if (values[i] < values[min_index]) {
+                    min_index = i;
+                }
+                if (values[i] > values[max_index]) {
+                    max_index = i;
+                }
+            }
+            if (end - begin <= 1000) {
+                assert(mins.QueryIndex(begin, end) == min_index);
+                assert(maxs.QueryIndex(begin, end) == max_index);
+                assert(mins.Query(begin, end) == values[min_index]);
+            }
+        }
+    }
+    SimpleVector<int> values{3, 1, 4, 1, 5, 9, 2, 6};
+    MinSparseTable<int> mins(values);
+    assert(mins.QueryIndex(0, 8) == 1);
+    assert(mins.QueryIndex(2, 8) == 3);
+    assert(MaxSparseTable<int>(values).Query(0, 5) == 5);
+    const int raw[] = {7, 2, 8, 2, 9};
+    MinSparseTable<int> raw_mins(SimpleVectorView<int>(raw, 5));
+    assert(raw_mins.GetSize() == 5 && raw_mins.QueryIndex(0, 5) == 1 && raw_mins.Query(2, 5) == 2);
+    MaxSparseTable<int> tail_maxs(SimpleVectorView<int>(values).Subview(4, 8));
+    assert(tail_maxs.Query(0, 4) == 9);
+    cout << "Done!"s << endl << endl;
+}
+
+string GapToString(const GapVector<char>& text) {
+    string result;
+    text.ForEach([&result](char c) {
+        result += c;
+    });
+    return result;
+}
+
+void TestGapVector() {
+    cout << "Test gap vector"s << endl;
+    GapVector<char> text;
+    const string hello = "hello world"s;
+    text.Insert(hello.begin(), hello.end());
+    assert(GapToString(text) == hello);
+    assert(text.GetCursor() == hello.size());
+
+    text.MoveCursor(5);
+    text.Insert(',');
+    assert(GapToString(text) == "hello, world"s);
+    text.EraseBefore(6);
+    assert(GapToString(text) == " world"s && text.GetCursor() == 0);
+    text.Insert('W');
+    text.EraseAfter(1);
+    text.EraseAt(1);
+    assert(GapToString(text) == "World"s);
+    text.InsertAt(5, '!');
+    text.PushBack('?');
+    assert(GapToString(text) == "World!?"s);
+    assert(text[0] == 'W' && text.At(6) == '?');
+
+    auto [before, after] = text.GetSpans();
+    assert(before.size + after.size == text.GetSize());
+
+    GapVector<char> copy = text;
+    assert(copy == text);
+    copy.MoveCursor(0);
+    copy.Insert('>');
+    assert(copy != text);
+    assert(copy.GetSize() == text.GetSize() + 1);
+
+    GapVector<X> noncopiable;
+    for (size_t i = 0; i < 10; ++i) {
+        noncopiable.Insert(X(i));
+        noncopiable.MoveCursor(noncopiable.GetCursor() / 2);
+    }
+    size_t sum = 0;
+    noncopiable.ForEach([&sum](const X& x) {
+        sum += x.GetX();
+    });
+    assert(sum == 45);
+    cout << "Done!"s << endl << endl;
+}
+
+template <typename Type>
+bool SameItems(const TreeVector<Type>& tree, const SimpleVector<Type>& expected) {
+    if (tree.GetSize() != expected.GetSize()) {
+        return false;
+    }
+    size_t index = 0;
+    for (const Type& item : tree) {
+        if (item != expected[index++]) {
+            return false;
+        }
+    }
+    return index == expected.GetSize();
+}
+
+void TestTreeVector() {
+    cout << "Test tree vector"s << endl;
+    TreeVector<int> tree;
+    SimpleVector<int> expected;
+    for (int step = 0; step < 20000; ++step) {
+        const size_t size = expected.GetSize();
+        if (size > 0 && step % 3 == 0) {
+            const size_t index = (static_cast<size_t>(step) * 7919) % size;
+            tree.Erase(index);
+            expected.Erase(expected.begin() + index);
+        }
+        else {
+            const size_t index = (static_cast<size_t>(step) * 104729) % (size + 1);
+            tree.Insert(index, step);
+            expected.Insert(expected.begin() + index, step);
+        }
+        if (step % 1000 == 0) {
+            assert(SameItems(tree, expected));
+        }
+    }
+    assert(SameItems(tree, expected));
+    for (size_t i = 0; i < expected.GetSize(); i += 37) {
+        assert(tree[i] == expected[i]);
+    }
+
+    TreeVector<int> tail = tree.Split(1234);
+    assert(tree.GetSize() == 1234);
+    assert(tail.GetSize() == expected.GetSize() - 1234);
+    assert(tail[0] == expected[1234] && tree[1233] == expected[1233]);
+    tail.Insert(0, -1);
+    tail.Erase(0);
+    tree.Concat(std::move(tail));
+    assert(tail.IsEmpty());
+    assert(SameItems(tree, expected));
+
+    TreeVector<int> copy = tree;
+    while (!copy.IsEmpty()) {
+        copy.Erase(copy.GetSize() / 2);
+    }
+    assert(copy.begin() == copy.end());
+    assert(tree.Split(0).GetSize() == expected.GetSize());
+    assert(tree.IsEmpty());
+
+    TreeVector<int> small{1, 2, 3};
+    small.PushBack(4);
+    TreeVector<int> rest = small.Split(2);
+    assert((small == TreeVector<int>{1, 2}) && (rest == TreeVector<int>{3, 4}));
+    try {
+        small.At(5);
+        assert(false);
+    }
+    catch (const out_of_range&) {
+    }
+
+    TreeVector<X> noncopiable;
+    for (size_t i = 0; i < 100; ++i) {
+        noncopiable.Insert(i / 2, X(i));
+    }
+    assert(noncopiable.GetSize() == 100);
+    cout << "Done!"s << endl << endl;
+}
+
+static_assert(!std::is_copy_constructible_v<PersistentVector<int>::Transient>);
+static_assert(!std::is_copy_assignable_v<PersistentVector<int>::Transient>);
+static_assert(std::is_nothrow_move_constructible_v<PersistentVector<int>::Transient>);
+
+void TestPersistentVector() {
+    cout << "Test persistent vector"s << endl;
+    PersistentVector<int> empty;
+    assert(empty.IsEmpty());
+
+    // Версии не влияют друг на друга при росте через несколько уровней
+    const size_t size = 40000;
+    SimpleVector<PersistentVector<int>> versions;
+    PersistentVector<int> current;
+    for (size_t i = 0; i < size; ++i) {
+        if (i % 1000 == 0) {
+            versions.PushBack(current);
+        }
+        current = current.PushBack(static_cast<int>(i));
+    }
+    assert(current.GetSize() == size);
+    for (size_t i = 0; i < size; ++i) {
+        assert(current[i] == static_cast<int>(i));
+    }
+    for (size_t v = 0; v < versions.GetSize(); ++v) {
+        assert(versions[v].GetSize() == v * 1000);
+        for (size_t i = 0; i < versions[v].GetSize(); i += 37) {
+            assert(versions[v][i] == static_cast<int>(i));
+        }
+    }
+
+    const auto changed = current.Set(5, -5).Set(size - 1, -1).Set(20000, -2);
+    assert(changed[5] == -5 && changed[size - 1] == -1 && changed[20000] == -2);
+    assert(current[5] == 5 && current[size - 1] == static_cast<int>(size - 1) && current[20000] == 20000);
+
+    // PopBack до пустого, сверяя содержимое на границах листьев
+    PersistentVector<int> shrinking = current;
+    for (size_t i = size; i > 0; --i) {
+        assert(shrinking.GetSize() == i);
+        assert(shrinking[i - 1] == static_cast<int>(i - 1));
+        if (i % 997 == 0) {
+            assert(shrinking[0] == 0 && shrinking[i / 2] == static_cast<int>(i / 2));
+        }
+        shrinking = shrinking.PopBack();
+    }
+    assert(shrinking.IsEmpty());
+    assert(current.GetSize() == size && current[size - 1] == static_cast<int>(size - 1));
+    shrinking = shrinking.PushBack(7);
+    assert(shrinking.GetSize() == 1 && shrinking[0] == 7);
+
+    // Пакетные правки через Transient не трогают исходную версию
+    auto transient = current.AsTransient();
+    for (size_t i = 0; i < size; i += 2) {
+        transient.Set(i, -static_cast<int>(i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        transient.PushBack(i);
+    }
+    transient.PopBack();
+    const auto bulk = transient.Persistent();
+    transient.Set(1, 100);
+    assert(bulk.GetSize() == size + 99);
+    assert(bulk[1] == 1 && bulk[2] == -2 && bulk[size + 98] == 98);
+    assert(transient[1] == 100);
+    for (size_t i = 0; i < size; ++i) {
+        assert(current[i] == static_cast<int>(i));
+    }
+
+    // Перемещённый Transient пуст, и правки через него не видны новому
+    // владельцу и снимку
+    auto moved = std::move(transient);
+    const auto snapshot = moved.Persistent();
+    assert(transient.GetSize() == 0);
+    transient.PushBack(5).PushBack(6).PopBack();
+    assert(transient.GetSize() == 1 && transient[0] == 5);
+    moved.Set(1, 200).Set(2, 300);
+    transient = std::move(moved);
+    transient.Set(1, 400);
+    assert(moved.GetSize() == 0);
+    moved.PushBack(8);
+    assert(snapshot[1] == 100 && snapshot[2] == -2 && snapshot.GetSize() == size + 99);
+    assert(transient[1] == 400 && transient[2] == 300 && bulk[1] == 1);
+
+    SimpleVector<int> source(1000);
+    std::iota(source.begin(), source.end(), 0);
+    const PersistentVector<int> from_vector(source);
+    assert(from_vector.ToSimpleVector() == source);
+    long long sum = 0;
+    from_vector.ForEach([&sum](int value) {
+        sum += value;
+    });
+    assert(sum == 999 * 1000 / 2);
+    try {
+        from_vector.At(1000);
+        assert(false);
+    }
+    catch (const out_of_range&) {
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestCowVector() {
+    cout << "Test copy-on-write vector"s << endl;
+    CowVector<int> original{1, 2, 3, 4};
+    const CowVector<int> copy = original;
+    assert(original.UseCount() == 2 && copy.IsShared());
+    assert(copy.cbegin() == original.cbegin());
+    assert(copy == original);
+
+    // Чтение через константную ссылку не отделяет буфер
+    const CowVector<int>& reader = original;
+    assert(reader[2] == 3 && reader.At(3) == 4);
+    assert(original.UseCount() == 2);
+
+    original[0] = 10;
+    assert(original.UseCount() == 1 && copy.UseCount() == 1);
+    assert(original[0] == 10 && copy[0] == 1);
+    assert(copy < original && original > copy);
+
+    CowVector<int> third = copy;
+    third.Insert(third.cbegin() + 1, 7);
+    assert(third.GetItems() == SimpleVector<int>({1, 7, 2, 3, 4}));
+    assert(copy.GetItems() == SimpleVector<int>({1, 2, 3, 4}));
+    third.Erase(third.cbegin());
+    third.PopBack();
+    assert(third.GetItems() == SimpleVector<int>({7, 2, 3}));
+
+    CowVector<int> fourth = copy;
+    fourth.MakeUnique();
+    assert(!fourth.IsShared() && fourth == copy && fourth.cbegin() != copy.cbegin());
+    CowVector<int> fifth = copy;
+    fifth.Clear();
+    assert(fifth.IsEmpty() && copy.GetSize() == 4);
+    fifth.Reserve(10);
+    assert(fifth.GetCapacity() >= 10);
+    fifth.PushBack(5);
+    assert(fifth.GetSize() == 1 && fifth[0] == 5);
+    try {
+        reader.At(4);
+        assert(false);
+    }
+    catch (const out_of_range&) {
+    }
+
+    // Копии раздаются потокам и читаются, пока владелец меняет свою
+    CowVector<int> shared(SimpleVector<int>(10000, 1));
+    SimpleVector<long long> sums(4);
+    SimpleVector<std::thread> threads;
+    for (size_t i = 0; i < sums.GetSize(); ++i) {
+        threads.PushBack(std::thread([snapshot = shared, &sum = sums[i]]() {
+            sum = std::accumulate(snapshot.cbegin(), snapshot.cend(), 0LL);
+        }));
+    }
+    for (int& value : shared) {
+        value = 2;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (long long sum : sums) {
+        assert(sum == 10000);
+    }
+    assert(shared.UseCount() == 1 && shared[9999] == 2);
+
+    // После выдачи изменяемой ссылки копии получают собственные данные
+    CowVector<int> leaked{1, 2, 3};
+    int& first = leaked[0];
+    CowVector<int> snapshot = leaked;
+    assert(!leaked.IsShared() && !snapshot.IsShared());
+    first = 42;
+    assert(leaked[0] == 42 && snapshot[0] == 1);
+    const SharedSlice<int> slice(leaked);
+    first = 43;
+    assert(slice[0] == 42);
+    leaked.Clear();
+    leaked.PushBack(5);
+    const CowVector<int> shares = leaked;
+    assert(leaked.IsShared());
+    cout << "Done!"s << endl << endl;
+}
+
+void TestSharedSlice() {
+    cout << "Test shared slice"s << endl;
+    SimpleVector<int> source(100);
+    std::iota(source.begin(), source.end(), 0);
+    const int* data = source.begin();
+    SharedSlice<int> whole(std::move(source));
+    assert(whole.GetSize() == 100 && whole.GetData() == data);
+
+    const auto middle = whole.Subslice(10, 60);
+    const auto inner = middle.Subslice(5, 15);
+    assert(inner.GetSize() == 10 && inner[0] == 15 && inner.GetData() == data + 15);
+    assert(whole.UseCount() == 3);
+
+    const auto chunks = whole.Split(30);
+    assert(chunks.GetSize() == 4 && chunks[3].GetSize() == 10 && chunks[3][9] == 99);
+    assert(chunks[1] == whole.Subslice(30, 60) && chunks[0] < chunks[1]);
+
+    // Родитель освобождён, но срез держит буфер живым
+    whole = SharedSlice<int>();
+    assert(inner.At(9) == 24);
+    try {
+        inner.At(10);
+        assert(false);
+    }
+    catch (const out_of_range&) {
+    }
+
+    SharedSlice<int> copied = middle;
+    const SimpleVector<int> owned = std::move(copied).Detach();
+    assert(owned.GetSize() == 50 && owned[0] == 10 && owned.begin() != middle.GetData());
+    assert(copied.IsEmpty());
+
+    SimpleVector<int> unique_source(8, 3);
+    const int* unique_data = unique_source.begin();
+    SharedSlice<int> unique(std::move(unique_source));
+    const SimpleVector<int> adopted = std::move(unique).Detach();
+    assert(adopted.begin() == unique_data && adopted.GetSize() == 8);
+
+    CowVector<int> cow{1, 2, 3};
+    const SharedSlice<int> view(cow);
+    assert(view.GetData() == cow.cbegin() && cow.IsShared());
+    cow[0] = 100;
+    assert(view[0] == 1 && cow[0] == 100);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestSimpleVectorView() {
+    cout << "Test simple vector view"s << endl;
+    SimpleVector<int> owned{5, 1, 4, 2, 3};
+    const SimpleVectorView<int> view(owned);
+    assert(view.GetData() == owned.begin() && view.GetSize() == 5);
+    assert(view == owned && owned == view && view[2] == 4 && view.At(4) == 3);
+    try {
+        view.At(5);
+        assert(false);
+    }
+    catch (const out_of_range&) {
+    }
+
+    // Внешний буфер без копирования
+    ArrayPtr<int> raw(4);
+    std::iota(raw.Get(), raw.Get() + 4, 1);
+    const SimpleVectorView<int> from_array(raw, 4);
+    const SimpleVectorView<int> from_pointer(raw.Get() + 1, 2);
+    assert(from_array.Subview(1, 3) == from_pointer);
+    assert(from_array < view && view > from_array && from_pointer != owned);
+    assert(*std::max_element(view.begin(), view.end()) == 5);
+    assert(from_array.ToSimpleVector() == SimpleVector<int>({1, 2, 3, 4}));
+
+    MutableSimpleVectorView<int> mutable_view(owned);
+    std::sort(mutable_view.begin(), mutable_view.end());
+    assert(owned == SimpleVector<int>({1, 2, 3, 4, 5}));
+    mutable_view.Subview(3, 5)[0] = 40;
+    assert(owned[3] == 40 && mutable_view == owned && mutable_view > from_array);
+
+    // Алгоритмы, принимающие представление
+    const SimpleVectorView<int> head = view.Subview(0, 4);
+    assert(Filter(head, CompareOp::Greater, 1) == SimpleVector<int>({2, 3, 40}));
+    assert(FilterSelection(head, CompareOp::Less, 3) == SimpleVector<uint32_t>({0, 1}));
+    assert(Compact(head, FilterMask(head, CompareOp::Equal, 40)) == SimpleVector<int>({40}));
+    assert(SimpleVectorView<int>().IsEmpty());
+
+    // Чужой буфер обрабатывается остальными алгоритмами без копирования в SimpleVector
+    int64_t external[] = {5, 3, 9, 3, 7, 1};
+    const SimpleVectorView<int64_t> column(external, 6);
+    const uint32_t order_data[] = {5, 1, 3, 0, 4, 2};
+    const SimpleVectorView<uint32_t> order(order_data, 6);
+    int64_t gathered_data[6];
+    const MutableSimpleVectorView<int64_t> gathered(gathered_data, 6);
+    Gather(column, order, gathered);
+    assert(gathered == SimpleVector<int64_t>({1, 3, 3, 5, 7, 9}));
+    assert(Gather(column, order.Subview(0, 2)) == SimpleVector<int64_t>({1, 3}));
+    int64_t scattered_data[6] = {};
+    Scatter(SimpleVectorView<int64_t>(gathered), order, MutableSimpleVectorView<int64_t>(scattered_data, 6));
+    assert(SimpleVectorView<int64_t>(scattered_data, 6) == column);
+    assert(TopK(column, 2) == SimpleVector<int64_t>({9, 7}) && BottomKIndices(column, 1)[0] == 5);
+    assert(Unique(column) == SimpleVector<int64_t>({1, 3, 5, 7, 9}));
+    assert(DistinctIndices(column, UniqueStrategy::Hash).GetSize() == 5);
+    assert(RadixSortIndices(column)[0] == 5);
+    assert(FenwickTree<int64_t>(column).RangeSum(1, 4) == 15);
+    assert(MinSegmentTree<int64_t>(column).Query(0, 4) == 3);
+    const GroupByResult<int64_t, int64_t> grouped = GroupBy<int64_t, int64_t>(column).AddValues(gathered).Run();
+    assert(grouped.GetGroupCount() == 5 && grouped.columns[0].sums.GetSize() == 5);
+    const uint64_t keys_data[] = {1, 3, 5};
+    assert(MergeJoin(SimpleVectorView<uint64_t>(keys_data, 3), SimpleVectorView<uint64_t>(keys_data + 1, 2))
+               .GetSize() == 2);
+    const SimpleVector<uint64_t> probe{3, 4};
+    assert(HashJoin(SimpleVectorView<uint64_t>(keys_data, 3), SimpleVectorView<uint64_t>(probe)).GetSize() == 1);
+    SimpleVector<SimpleVectorView<int64_t>> runs(2);
+    runs[0] = gathered.Subview(0, 3);
+    runs[1] = gathered.Subview(3, 6);
+    assert(KWayMerge(runs) == SimpleVector<int64_t>({1, 3, 3, 5, 7, 9}));
+
+    // Изменение на месте через MutableSimpleVectorView
+    RadixSort(MutableSimpleVectorView<int64_t>(external, 6));
+    assert(column == gathered);
+    ApplyPermutation(MutableSimpleVectorView<int64_t>(external, 6), SimpleVectorView<uint32_t>(order_data, 6));
+    assert(external[0] == 9 && external[5] == 3);
+    assert(InclusiveScan(MutableSimpleVectorView<int64_t>(external, 3)) == 17 && external[2] == 17);
+
+    // Изменяемое представление передаётся в алгоритмы и сравнивается в любом порядке
+    const MutableSimpleVectorView<int64_t> editable(external, 6);
+    assert(Filter(editable, CompareOp::Greater, 4) == SimpleVector<int64_t>({9, 12, 17, 7}));
+    assert(Compact(editable, FilterMask(editable, CompareOp::Less, 4)) == SimpleVector<int64_t>({1, 3}));
+    assert(FilterSelection(editable, CompareOp::Equal, 7)[0] == 4);
+    assert(TopK(editable, 1)[0] == 17 && BottomK(editable, 1)[0] == 1 && TopKIndices(editable, 1)[0] == 2);
+    assert(BottomKIndices(editable, 2)[1] == 5);
+    assert(Unique(editable).GetSize() == 6 && DistinctIndices(editable).GetSize() == 6);
+    assert(RadixSortIndices(editable)[0] == 3);
+    const SimpleVector<int64_t> edited{9, 12, 17, 1, 7, 3};
+    assert(editable == edited && edited == editable && editable == SimpleVectorView<int64_t>(edited));
+    assert(SimpleVectorView<int64_t>(edited) == editable && editable == editable);
+    assert(column.Subview(0, 5) < editable && editable > column.Subview(0, 5) && edited >= editable);
+    assert(MutableSimpleVectorView<int64_t>(external, 5) != editable && gathered < editable);
+    static_assert(!std::is_constructible_v<SimpleVectorView<int>, SimpleVector<int>&&>);
+    assert(SimpleVectorView<int>(owned) == SimpleVector<int>({1, 2, 3, 40, 5}));
+    cout << "Done!"s << endl << endl;
+}
+
+void TestAdoptAndReleaseBuffer() {
+    cout << "Test adopt and release buffer"s << endl;
+    int freed = 0;
+    const ArrayDeleter<int> deleter{[](int* data, void* context) {
+        ++*static_cast<int*>(context);
+        std::free(data);
+    }, &freed};
+
+    // Буфер из C-кода становится вектором и обратно без копирования
+    int* raw = static_cast<int*>(std::calloc(8, sizeof(int)));
+    std::iota(raw, raw + 5, 1);
+    {
+        auto adopted = SimpleVector<int>::Adopt(raw, 5, 8, deleter);
+        assert(adopted.begin() == raw && adopted.GetSize() == 5 && adopted.GetCapacity() == 8);
+        adopted.PushBack(6);
+        assert(adopted.begin() == raw);
+
+        auto buffer = adopted.ReleaseBuffer();
+        assert(adopted.IsEmpty() && adopted.GetCapacity() == 0 && adopted.begin() == nullptr);
+        assert(buffer.data.get() == raw && buffer.size == 6 && buffer.capacity == 8);
+        assert(freed == 0);
+
+        auto again = SimpleVector<int>::Adopt(std::move(buffer));
+        assert(again.begin() == raw && again[5] == 6 && !buffer.data);
+        // Перевыделение освобождает чужой буфер его же способом
+        again.Reserve(100);
+        assert(freed == 1 && again.GetSize() == 6 && again[0] == 1);
+    }
+    assert(freed == 1);
+
+    raw = static_cast<int*>(std::calloc(4, sizeof(int)));
+    {
+        auto adopted = SimpleVector<int>::Adopt(raw, 4, 4, deleter);
+        SimpleVector<int> moved(std::move(adopted));
+        SimpleVector<int> target;
+        target = std::move(moved);
+        assert(target.begin() == raw);
+    }
+    assert(freed == 2);
+
+    // Буфер обычного вектора освобождается через delete[]
+    SimpleVector<X> owned;
+    owned.PushBack(X(3));
+    auto buffer = owned.ReleaseBuffer();
+    assert(buffer.size == 1 && buffer.data[0].GetX() == 3);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestSerialization() {
+    cout << "Test binary serialization"s << endl;
+    char path[] = "/tmp/simple_vector_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+
+    SimpleVector<double> first(1000);
+    std::iota(first.begin(), first.end(), 0.5);
+    SimpleVector<int16_t> second{-1, 2, -3};
+    WriteTo(fd, first);
+    WriteTo(fd, SimpleVectorView<int16_t>(second));
+
+    // Несколько векторов подряд читаются из одного потока
+    lseek(fd, 0, SEEK_SET);
+    assert(ReadFrom<double>(fd) == first);
+    assert(ReadFrom<int16_t>(fd) == second);
+
+    lseek(fd, 0, SEEK_SET);
+    try {
+        ReadFrom<int64_t>(fd);
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+
+    {
+        const MappedVector<double> mapped(path, true);
+        assert(mapped.GetView() == first && mapped[999] == 999.5);
+        assert(reinterpret_cast<uintptr_t>(mapped.GetView().GetData()) % 64 == 0);
+    }
+
+    // Порча данных обнаруживается контрольной суммой
+    const double broken = -1;
+    assert(pwrite(fd, &broken, sizeof(broken), 64 + 8 * 10) == sizeof(broken));
+    lseek(fd, 0, SEEK_SET);
+    try {
+        ReadFrom<double>(fd);
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+    lseek(fd, 0, SEEK_SET);
+    assert(ReadFrom<double>(fd, false)[10] == -1);
+    assert(MappedVector<double>(path).GetView()[10] == -1);
+    try {
+        MappedVector<double> verified(path, true);
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+
+    // Размеры из заголовка проверяются до выделения памяти
+    VectorFileHeader header;
+    assert(pread(fd, &header, sizeof(header), 0) == sizeof(header));
+    for (uint64_t count : {uint64_t{1} << 40, ~uint64_t{0}}) {
+        VectorFileHeader forged = header;
+        forged.count = count;
+        assert(pwrite(fd, &forged, sizeof(forged), 0) == sizeof(forged));
+        lseek(fd, 0, SEEK_SET);
+        try {
+            ReadFrom<double>(fd, false);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+    VectorFileHeader forged = header;
+    forged.data_offset = uint64_t{1} << 62;
+    assert(pwrite(fd, &forged, sizeof(forged), 0) == sizeof(forged));
+    lseek(fd, 0, SEEK_SET);
+    try {
+        ReadFrom<double>(fd, false);
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+
+    // Из канала длина неизвестна: буфер растёт по мере чтения
+    int channel[2];
+    assert(pipe(channel) == 0);
+    SimpleVector<int32_t> large(300000);
+    std::iota(large.begin(), large.end(), -5);
+    std::thread writer([&]() {
+        WriteTo(channel[1], large);
+        close(channel[1]);
+    });
+    assert(ReadFrom<int32_t>(channel[0]) == large);
+    writer.join();
+    close(channel[0]);
+
+    assert(ftruncate(fd, 0) == 0);
+    lseek(fd, 0, SEEK_SET);
+    WriteTo(fd, SimpleVector<int>());
+    assert(MappedVector<int>(path).GetView().IsEmpty());
+    close(fd);
+    unlink(path);
+    try {
+        MappedVector<int> missing(path);
+        assert(false);
+    }
+    catch (const std::system_error&) {
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestMmapVector() {
+    cout << "Test mmap vector"s << endl;
+    char path[] = "/tmp/mmap_vector_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    {
+        MmapVector<int64_t> values(path);
+        assert(values.IsEmpty());
+        for (int64_t i = 0; i < 100000; ++i) {
+            values.PushBack(i * i);
+        }
+        assert(values.GetSize() == 100000 && values.GetCapacity() >= 100000);
+        values[7] = -7;
+        values.Flush(0, 10);
+        values.Sync();
+        try {
+            values.At(100000);
+            assert(false);
+        }
+        catch (const out_of_range&) {
+        }
+    }
+    {
+        MmapVector<int64_t> values(path);
+        assert(values.GetSize() == 100000 && values[7] == -7 && values[99999] == int64_t{99999} * 99999);
+        values.Resize(10);
+        values.Sync();
+        values.PushBack(1);
+        values.PushBack(2);
+        values.Resize(20);
+        assert(values.GetView().Subview(10, 12) == SimpleVector<int64_t>({1, 2}) && values[19] == 0);
+        MmapVector<int64_t> moved(std::move(values));
+        assert(moved.GetSize() == 20);
+    }
+
+    // Повреждённая последняя копия заголовка: открывается предыдущая
+    const int raw = open(path, O_RDWR);
+    mmap_vector_detail::HeaderSlot slots[2];
+    for (size_t slot = 0; slot < 2; ++slot) {
+        assert(pread(raw, &slots[slot], sizeof(slots[slot]), slot * mmap_vector_detail::kSlotStride) ==
+               sizeof(slots[slot]));
+    }
+    const size_t latest = slots[0].sequence > slots[1].sequence ? 0 : 1;
+    assert(slots[latest].count == 20 && slots[1 - latest].count == 10);
+    slots[latest].count = 1000;
+    assert(pwrite(raw, &slots[latest], sizeof(slots[latest]), latest * mmap_vector_detail::kSlotStride) ==
+           sizeof(slots[0]));
+    close(raw);
+    {
+        MmapVector<int64_t> values(path);
+        assert(values.GetSize() == 10 && values[7] == -7);
+    }
+    try {
+        MmapVector<double> wrong_type(path);
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+    unlink(path);
+    cout << "Done!"s << endl << endl;
+}
+
+void TestChunkedStream() {
+    cout << "Test chunked stream"s << endl;
+    char path[] = "/tmp/chunked_stream_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    const size_t total = 100000;
+    {
+        ChunkedWriter<uint32_t> writer(fd, 4096);
+        SimpleVector<uint32_t> block(10000);
+        for (size_t begin = 0; begin < total / 2; begin += block.GetSize()) {
+            std::iota(block.begin(), block.end(), static_cast<uint32_t>(begin));
+            writer.Write(block);
+        }
+        for (size_t i = total / 2; i < total; ++i) {
+            writer.PushBack(static_cast<uint32_t>(i));
+        }
+        writer.Finish();
+    }
+
+    // Чтение кусками в один переиспользуемый буфер
+    lseek(fd, 0, SEEK_SET);
+    {
+        StreamHeader header;
+        assert(pread(fd, &header, sizeof(header), 0) == sizeof(header) && header.version == 1);
+        ChunkedReader<uint32_t> reader(fd);
+        assert(reader.GetChunkSize() == 4096);
+        SimpleVector<uint32_t> chunk;
+        size_t expected = 0;
+        size_t chunks = 0;
+        while (reader.Next(chunk)) {
+            assert(chunk.GetSize() <= 4096);
+            for (uint32_t value : chunk) {
+                assert(value == expected++);
+            }
+            ++chunks;
+        }
+        assert(expected == total && chunks == (total + 4095) / 4096);
+        assert(!reader.Next(chunk));
+    }
+
+    // Обрыв потока и порча данных обнаруживаются при чтении
+    lseek(fd, 0, SEEK_SET);
+    {
+        ChunkedReader<uint32_t> reader(fd);
+        SimpleVector<uint32_t> chunk;
+        assert(reader.Next(chunk));
+    }
+    const uint32_t broken = 7;
+    assert(pwrite(fd, &broken, sizeof(broken), 64 + 32 + 4096 * 4 + 32 + 100) == sizeof(broken));
+    assert(ftruncate(fd, 64 + 3 * (32 + 4096 * 4)) == 0);
+    for (bool verify : {true, false}) {
+        lseek(fd, 0, SEEK_SET);
+        ChunkedReader<uint32_t> reader(fd, verify);
+        SimpleVector<uint32_t> chunk;
+        assert(reader.Next(chunk));
+        try {
+            while (reader.Next(chunk)) {
+            }
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(!reader.Next(chunk));
+    }
+    close(fd);
+    unlink(path);
+
+    // Канал, в который данные больше не приходят: деструктор не зависает
+    int channel[2];
+    assert(pipe(channel) == 0);
+    {
+        ChunkedWriter<uint32_t> writer(channel[1], 16);
+        SimpleVector<uint32_t> block(20);
+        std::iota(block.begin(), block.end(), 0u);
+        writer.Write(block);
+        ChunkedReader<uint32_t> reader(channel[0]);
+        SimpleVector<uint32_t> chunk;
+        assert(reader.Next(chunk) && chunk.GetSize() == 16 && chunk[15] == 15);
+    }
+    close(channel[0]);
+    close(channel[1]);
+    cout << "Done!"s << endl << endl;
+}
+
+template <typename Vector, typename = void>
+struct CanStore : std::false_type {};
+
+template <typename Vector>
+struct CanStore<Vector, std::void_t<decltype(std::declval<AsyncVectorIo&>().Store(0, std::declval<Vector>()))>>
+    : std::true_type {};
+
+template <typename Vector, typename = void>
+struct CanStoreWithCallback : std::false_type {};
+
+template <typename Vector>
+struct CanStoreWithCallback<Vector, std::void_t<decltype(std::declval<AsyncVectorIo&>().Store(
+                                        0, std::declval<Vector>(), IoCallback()))>> : std::true_type {};
+
+// Временный вектор освободился бы раньше, чем завершится запись
+static_assert(CanStore<const SimpleVector<int>&>::value && CanStore<SimpleVector<int>&>::value);
+static_assert(!CanStore<SimpleVector<int>>::value && !CanStore<SimpleVector<int>&&>::value);
+static_assert(CanStoreWithCallback<SimpleVector<int>&>::value && !CanStoreWithCallback<SimpleVector<int>>::value);
+
+void TestAsyncVectorIo() {
+    cout << "Test async vector io"s << endl;
+    for (AsyncIoBackend backend : {AsyncIoBackend::Auto, AsyncIoBackend::ThreadPool}) {
+        AsyncVectorIo io(backend, 8, 4);
+        assert(io.GetBackend() != AsyncIoBackend::Auto);
+        const size_t file_count = 20;
+        SimpleVector<int> fds(file_count);
+        SimpleVector<string> paths;
+        SimpleVector<SimpleVector<int32_t>> sources(file_count);
+        SimpleVector<std::future<void>> stored;
+        for (size_t i = 0; i < file_count; ++i) {
+            char path[] = "/tmp/async_io_XXXXXX";
+            fds[i] = mkstemp(path);
+            assert(fds[i] >= 0);
+            paths.PushBack(path);
+            sources[i] = SimpleVector<int32_t>(1000 * (i + 1));
+            std::iota(sources[i].begin(), sources[i].end(), static_cast<int32_t>(i));
+            stored.PushBack(io.Store(fds[i], sources[i]));
+        }
+        for (auto& future : stored) {
+            future.get();
+        }
+
+        // Загрузка в заранее зарезервированные буферы, завершение — обратным вызовом
+        SimpleVector<SimpleVector<int32_t>> loaded(file_count);
+        SimpleVector<const int32_t*> reserved(file_count);
+        std::atomic<size_t> succeeded{0};
+        for (size_t i = 0; i < file_count; ++i) {
+            loaded[i].Reserve(sources[i].GetSize());
+            reserved[i] = loaded[i].begin();
+            io.Load(fds[i], loaded[i], [&succeeded](std::exception_ptr error) {
+                if (!error) {
+                    ++succeeded;
+                }
+            });
+        }
+        io.Wait();
+        assert(succeeded == file_count);
+        for (size_t i = 0; i < file_count; ++i) {
+            assert(loaded[i] == sources[i] && loaded[i].begin() == reserved[i]);
+        }
+
+        // Исключение из обратного вызова не роняет служебный поток
+        io.Load(fds[1], loaded[1], IoCallback([](std::exception_ptr) {
+                    throw std::logic_error("callback failed"s);
+                }));
+        io.Wait();
+        assert(loaded[1] == sources[1]);
+        lseek(fds[3], 0, SEEK_SET);
+        assert(ReadFrom<int32_t>(fds[3]) == sources[3]);
+
+        // Ошибки приходят через future
+        SimpleVector<int32_t> target;
+        assert(ftruncate(fds[0], 100) == 0);
+        try {
+            io.Load(fds[0], target).get();
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        try {
+            io.Load(-1, target).get();
+            assert(false);
+        }
+        catch (const std::system_error& error) {
+            assert(error.code().value() == EBADF);
+        }
+
+        // Заявленный размер сверяется с длиной файла до выделения памяти
+        VectorFileHeader header;
+        assert(pread(fds[2], &header, sizeof(header), 0) == sizeof(header));
+        header.count = uint64_t{1} << 40;
+        assert(pwrite(fds[2], &header, sizeof(header), 0) == sizeof(header));
+        try {
+            io.Load(fds[2], target).get();
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(target.IsEmpty());
+        for (size_t i = 0; i < file_count; ++i) {
+            close(fds[i]);
+            unlink(paths[i].c_str());
+        }
+    }
+    cout << "Done!"s << endl << endl;
+}
+
+void TestCompression() {
+    cout << "Test compression"s << endl;
+    std::mt19937_64 random(75);
+
+    // Прямое кодирование: сжимаемые данные сжимаются, случайные хранятся как есть
+    SimpleVector<int64_t> sorted(20000);
+    int64_t value = -1000000;
+    for (int64_t& item : sorted) {
+        value += static_cast<int64_t>(random() % 16);
+        item = value;
+    }
+    SimpleVector<uint64_t> noise(5000);
+    for (uint64_t& item : noise) {
+        item = random();
+    }
+    SimpleVector<double> smooth(10000);
+    for (size_t i = 0; i < smooth.GetSize(); ++i) {
+        smooth[i] = static_cast<double>(i / 8) * 0.5;
+    }
+    SimpleVector<uint8_t> encoded;
+    for (ChunkCodec codec : {ChunkCodec::Lz, ChunkCodec::ShuffleLz, ChunkCodec::DeltaShuffleLz}) {
+        const uint32_t flags = EncodeChunk(SimpleVectorView<int64_t>(sorted), codec, encoded);
+        assert(flags == static_cast<uint32_t>(codec));
+        SimpleVector<int64_t> decoded(sorted.GetSize());
+        DecodeChunk(encoded.begin(), encoded.GetSize(), flags, decoded.begin(), decoded.GetSize());
+        assert(decoded == sorted);
+    }
+    assert(encoded.GetSize() * 4 < sorted.GetSize() * sizeof(int64_t));
+    assert(EncodeChunk(SimpleVectorView<uint64_t>(noise), ChunkCodec::DeltaShuffleLz, encoded) == 0);
+    assert(encoded.IsEmpty());
+    {
+        const uint32_t flags = EncodeChunk(SimpleVectorView<double>(smooth), ChunkCodec::DeltaShuffleLz, encoded);
+        assert(flags == static_cast<uint32_t>(ChunkCodec::ShuffleLz));
+        SimpleVector<double> decoded(smooth.GetSize());
+        DecodeChunk(encoded.begin(), encoded.GetSize(), flags, decoded.begin(), decoded.GetSize());
+        assert(decoded == smooth);
+    }
+
+    // Испорченный вход даёт исключение, а не выход за границы
+    const uint32_t flags = EncodeChunk(SimpleVectorView<int64_t>(sorted), ChunkCodec::ShuffleLz, encoded);
+    size_t rejected = 0;
+    for (int attempt = 0; attempt < 300; ++attempt) {
+        SimpleVector<uint8_t> broken = encoded;
+        broken[random() % broken.GetSize()] ^= static_cast<uint8_t>(1 + random() % 255);
+        const size_t size = attempt % 3 == 0 ? random() % broken.GetSize() : broken.GetSize();
+        SimpleVector<int64_t> decoded(sorted.GetSize());
+        try {
+            DecodeChunk(broken.begin(), size, flags, decoded.begin(), decoded.GetSize());
+        }
+        catch (const std::runtime_error&) {
+            ++rejected;
+        }
+    }
+    assert(rejected > 0);
+    try {
+        SimpleVector<double> decoded(4);
+        DecodeChunk(encoded.begin(), encoded.GetSize(), static_cast<uint32_t>(ChunkCodec::DeltaShuffleLz),
+                    decoded.begin(), decoded.GetSize());
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+
+    // Сжатый поток: последовательная запись и параллельное чтение совместимы
+    char path[] = "/tmp/compression_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    {
+        ChunkedWriter<int64_t> writer(fd, 4096, ChunkCodec::DeltaShuffleLz);
+        writer.Write(sorted);
+        writer.Write(SimpleVectorView<int64_t>(reinterpret_cast<const int64_t*>(noise.begin()), noise.GetSize()));
+        writer.Finish();
+    }
+    const off_t stream_size = lseek(fd, 0, SEEK_CUR);
+    assert(static_cast<size_t>(stream_size) < (sorted.GetSize() + noise.GetSize()) * sizeof(int64_t));
+    lseek(fd, 0, SEEK_SET);
+    {
+        SimpleVector<int64_t> all = ReadChunked<int64_t>(fd, 4);
+        assert(all.GetSize() == sorted.GetSize() + noise.GetSize());
+        assert(std::equal(sorted.begin(), sorted.end(), all.begin()));
+        assert(std::memcmp(all.begin() + sorted.GetSize(), noise.begin(), noise.GetSize() * sizeof(int64_t)) == 0);
+    }
+
+    // Параллельная запись читается последовательным читателем
+    assert(ftruncate(fd, 0) == 0);
+    lseek(fd, 0, SEEK_SET);
+    WriteChunked(fd, sorted, ChunkCodec::DeltaShuffleLz, 4, 1000);
+    assert(lseek(fd, 0, SEEK_CUR) * 4 < static_cast<off_t>(sorted.GetSize() * sizeof(int64_t)));
+    lseek(fd, 0, SEEK_SET);
+    {
+        ChunkedReader<int64_t> reader(fd);
+        assert(reader.GetChunkSize() == 1000);
+        SimpleVector<int64_t> chunk;
+        size_t offset = 0;
+        while (reader.Next(chunk)) {
+            assert(std::equal(chunk.begin(), chunk.end(), sorted.begin() + offset));
+            offset += chunk.GetSize();
+        }
+        assert(offset == sorted.GetSize());
+    }
+    lseek(fd, 0, SEEK_SET);
+    assert(ReadChunked<int64_t>(fd, 3) == sorted);
+
+    // Сжатый поток помечен версией 2: старый читатель сообщит о версии
+    StreamHeader stream_header;
+    assert(pread(fd, &stream_header, sizeof(stream_header), 0) == sizeof(stream_header));
+    assert(stream_header.version == 2);
+    for (uint32_t version : {1u, 3u}) {
+        StreamHeader forged = stream_header;
+        forged.version = version;
+        assert(pwrite(fd, &forged, sizeof(forged), 0) == sizeof(forged));
+        lseek(fd, 0, SEEK_SET);
+        try {
+            ReadChunked<int64_t>(fd);
+            assert(false);
+        }
+        catch (const std::runtime_error& error) {
+            assert((string(error.what()).find("version") != string::npos) == (version == 3));
+        }
+    }
+    assert(pwrite(fd, &stream_header, sizeof(stream_header), 0) == sizeof(stream_header));
+
+    // Порча сжатого куска обнаруживается с проверкой суммы и без неё
+    const uint8_t garbage = 0xAB;
+    assert(pwrite(fd, &garbage, 1, 64 + 32 + 40) == 1);
+    for (bool verify : {true, false}) {
+        lseek(fd, 0, SEEK_SET);
+        try {
+            SimpleVector<int64_t> all = ReadChunked<int64_t>(fd, 4, verify);
+            assert(!verify && all != sorted);
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+
+    // При множестве потоков пачка ограничена IOV_MAX / 2 кусками
+    assert(ftruncate(fd, 0) == 0);
+    lseek(fd, 0, SEEK_SET);
+    const SimpleVector<int64_t> small_chunks = SimpleVectorView<int64_t>(sorted).Subview(0, 1500).ToSimpleVector();
+    WriteChunked(fd, small_chunks, ChunkCodec::None, 300, 1);
+    lseek(fd, 0, SEEK_SET);
+    assert(ReadChunked<int64_t>(fd) == small_chunks);
+    close(fd);
+    unlink(path);
+    cout << "Done!"s << endl << endl;
+}
+
 int main() {
     TestTemporaryObjConstructor();
     TestTemporaryObjOperator();
@@ -159,5 +1808,33 @@ int main() {
     TestNoncopiablePushBack();
     TestNoncopiableInsert();
     TestNoncopiableErase();
+    TestHeapVector();
+    TestIndexedHeapVector();
+    TestSlotMap();
+    TestUnorderedErase();
+    TestEraseIfAndIndices();
+    TestFilter();
+    TestGatherScatterPermutation();
+    TestScans();
+    TestGroupBy();
+    TestJoins();
+    TestTopK();
+    TestRadixSort();
+    TestUnique();
+    TestKWayMerge();
+    TestRangeQueries();
+    TestSparseTable();
+    TestGapVector();
+    TestTreeVector();
+    TestPersistentVector();
+    TestCowVector();
+    TestSharedSlice();
+    TestSimpleVectorView();
+    TestAdoptAndReleaseBuffer();
+    TestSerialization();
+    TestMmapVector();
+    TestChunkedStream();
+    TestAsyncVectorIo();
+    TestCompression();
     return 0;
 }
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#include "parallel.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+namespace merge_detail {
+
+constexpr size_t kMinParallelOutput = size_t{1} << 16;
+
+template <typename Type>
+struct Source {
+    const Type* current = nullptr;
+    const Type* end = nullptr;
+};
+
+// Дерево проигравших над k источниками: узлы 1..k-1 хранят проигравших в
+// своих поддеревьях, узел 0 — победителя. После выдачи элемента
+// перепроверяется только путь от его листа к корню, то есть log k сравнений.
+// При равенстве побеждает источник с меньшим номером, поэтому слияние устойчиво.
+template <typename Type, typename Compare>
+class LoserTree {
+public:
+    LoserTree(SimpleVector<Source<Type>>&& sources, Compare compare)
+        : sources_(std::move(sources)), nodes_(sources_.GetSize()), compare_(compare) {
+        const size_t k = sources_.GetSize();
+        if (k == 0) {
+            return;
+        }
+        SimpleVector<size_t> winners(2 * k);
+        for (size_t leaf = 0; leaf < k; ++leaf) {
+            winners[k + leaf] = leaf;
+        }
+        for (size_t node = k - 1; node > 0; --node) {
+            const size_t left = winners[2 * node];
+            const size_t right = winners[2 * node + 1];
+            if (Beats(left, right)) {
+                winners[node] = left;
+                nodes_[node] = right;
+            }
+            else {
+                winners[node] = right;
+                nodes_[node] = left;
+            }
+        }
+        nodes_[0] = k == 1 ? 0 : winners[1];
+    }
+
+    bool IsEmpty() const noexcept {
+        return sources_.IsEmpty() || IsExhausted(nodes_[0]);
+    }
+
+    const Type& Top() const noexcept {
+        assert(!IsEmpty());
+        return *sources_[nodes_[0]].current;
+    }
+
+    void Pop() noexcept {
+        assert(!IsEmpty());
+        size_t winner = nodes_[0];
+        ++sources_[winner].current;
+        const size_t k = sources_.GetSize();
+        for (size_t node = (winner + k) / 2; node > 0; node /= 2) {
+            if (Beats(nodes_[node], winner)) {
+                std::swap(nodes_[node], winner);
+            }
+        }
+        nodes_[0] = winner;
+    }
+
+private:
+    bool IsExhausted(size_t source) const noexcept {
+        return sources_[source].current == sources_[source].end;
+    }
+
+    bool Beats(size_t lhs, size_t rhs) const {
+        if (IsExhausted(lhs)) {
+            return false;
+        }
+        if (IsExhausted(rhs)) {
+            return true;
+        }
+        if (compare_(*sources_[lhs].current, *sources_[rhs].current)) {
+            return true;
+        }
+        if (compare_(*sources_[rhs].current, *sources_[lhs].current)) {
+            return false;
+        }
+        return lhs < rhs;
+    }
+
+    SimpleVector<Source<Type>> sources_;
+    SimpleVector<size_t> nodes_;
+    Compare compare_;
+};
+
+template <typename Type, typename Compare>
+void MergeSources(SimpleVector<Source<Type>>&& sources, Type* output, Compare compare) {
+    if (sources.GetSize() == 1) {
+        std::copy(sources[0].current, sources[0].end, output);
+        return;
+    }
+    LoserTree<Type, Compare> tree(std::move(sources), compare);
+    while (!tree.IsEmpty()) {
+        *output++ = tree.Top();
+        tree.Pop();
+    }
+}
+
+// Сколько элементов каждого прогона попадает в первые rank элементов
+// результата (с учётом устойчивости по номеру прогона). Для прогона j
+// позиция p входит в префикс, если число элементов, идущих в результате
+// раньше runs[j][p], меньше rank; эта величина монотонна по p, поэтому
+// граница ищется двоичным поиском.
+template <typename Type, typename Compare>
+SimpleVector<size_t> SplitRuns(const SimpleVector<SimpleVectorView<Type>>& runs, size_t rank, Compare compare) {
+    const size_t k = runs.GetSize();
+    SimpleVector<size_t> cuts(k);
+    for (size_t run = 0; run < k; ++run) {
+        auto preceding = [&](const Type& value, size_t position) {
+            size_t count = position;
+            for (size_t other = 0; other < k; ++other) {
+                if (other < run) {
+                    count += static_cast<size_t>(std::upper_bound(runs[other].begin(), runs[other].end(), value, compare)
+                                                 - runs[other].begin());
+                }
+                else if (other > run) {
+                    count += static_cast<size_t>(std::lower_bound(runs[other].begin(), runs[other].end(), value, compare)
+                                                 - runs[other].begin());
+                }
+            }
+            return count;
+        };
+        size_t low = 0;
+        size_t high = runs[run].GetSize();
+        while (low < high) {
+            const size_t middle = low + (high - low) / 2;
+            if (preceding(runs[run][middle], middle) < rank) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        cuts[run] = low;
+    }
+    return cuts;
+}
+
+}  // namespace merge_detail
+
+// Сливает отсортированные по compare прогоны в output, размер которого
+// равен суммарной длине прогонов. Слияние устойчиво: равные элементы идут в
+// порядке номеров прогонов. При thread_count > 1 результат делится на
+// равные части; границы частей в каждом прогоне находятся точным поиском
+// ранга, и части сливаются независимо деревьями проигравших.
+template <typename Type, typename Compare = std::less<Type>>
+void KWayMerge(const SimpleVector<SimpleVectorView<Type>>& runs, MutableSimpleVectorView<Type> output,
+               size_t thread_count = 1, Compare compare = Compare{}) {
+    size_t total = 0;
+    for (SimpleVectorView<Type> run : runs) {
+        assert(std::is_sorted(run.begin(), run.end(), compare));
+        total += run.GetSize();
+    }
+    assert(output.GetSize() == total);
+    if (total == 0) {
+        return;
+    }
+
+    const size_t part_count = std::min(thread_count, total / merge_detail::kMinParallelOutput);
+    if (part_count <= 1) {
+        SimpleVector<merge_detail::Source<Type>> sources(runs.GetSize());
+        for (size_t run = 0; run < runs.GetSize(); ++run) {
+            sources[run] = {runs[run].begin(), runs[run].end()};
+        }
+        merge_detail::MergeSources(std::move(sources), output.begin(), compare);
+        return;
+    }
+
+    SimpleVector<SimpleVector<size_t>> cuts(part_count + 1);
+    ParallelFor(part_count + 1, part_count, [&](size_t part) {
+        cuts[part] = merge_detail::SplitRuns(runs, SplitRange(total, part_count, part).first, compare);
+    });
+    ParallelFor(part_count, part_count, [&](size_t part) {
+        SimpleVector<merge_detail::Source<Type>> sources(runs.GetSize());
+        for (size_t run = 0; run < runs.GetSize(); ++run) {
+            sources[run] = {runs[run].begin() + cuts[part][run], runs[run].begin() + cuts[part + 1][run]};
+        }
+        merge_detail::MergeSources(std::move(sources), output.begin() + SplitRange(total, part_count, part).first,
+                                   compare);
+    });
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<Type> KWayMerge(const SimpleVector<SimpleVectorView<Type>>& runs, size_t thread_count = 1,
+                             Compare compare = Compare{}) {
+    size_t total = 0;
+    for (SimpleVectorView<Type> run : runs) {
+        total += run.GetSize();
+    }
+    SimpleVector<Type> output(total);
+    KWayMerge(runs, MutableSimpleVectorView<Type>(output), thread_count, compare);
+    return output;
+}
+
+// Ёмкость output переиспользуется.
+template <typename Type, typename Compare = std::less<Type>>
+void KWayMerge(const SimpleVector<SimpleVector<Type>>& runs, SimpleVector<Type>& output, size_t thread_count = 1,
+               Compare compare = Compare{}) {
+    SimpleVector<SimpleVectorView<Type>> views(runs.GetSize());
+    size_t total = 0;
+    for (size_t run = 0; run < runs.GetSize(); ++run) {
+        views[run] = runs[run];
+        total += runs[run].GetSize();
+    }
+    output.Resize(total);
+    KWayMerge(views, MutableSimpleVectorView<Type>(output), thread_count, compare);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<Type> KWayMerge(const SimpleVector<SimpleVector<Type>>& runs, size_t thread_count = 1,
+                             Compare compare = Compare{}) {
+    SimpleVector<Type> output;
+    KWayMerge(runs, output, thread_count, compare);
+    return output;
+}
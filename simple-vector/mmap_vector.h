@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "serialization.h"
+#include "simple_vector_view.h"
+
+namespace mmap_vector_detail {
+
+constexpr char kMagic[8] = {'S', 'V', 'M', 'M', 'A', 'P', '\0', '\0'};
+constexpr uint32_t kVersion = 2;
+// Копии заголовка лежат в разных блоках по 4 КиБ: разорванная запись
+// одного блока не портит обе сразу.
+constexpr size_t kSlotStride = 4096;
+constexpr size_t kDataOffset = 2 * kSlotStride;
+constexpr size_t kMinGrowBytes = 64 * 1024;
+
+// Одна из двух копий заголовка. Действует копия с верной суммой и
+// наибольшим sequence, поэтому оборванная запись заголовка не портит файл.
+struct HeaderSlot {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianness;
+    uint32_t type_tag;
+    uint32_t element_size;
+    uint64_t sequence;
+    uint64_t count;
+    uint64_t checksum;
+    uint8_t reserved[16];
+};
+
+static_assert(sizeof(HeaderSlot) == 64, "HeaderSlot must stay 64 bytes");
+
+inline uint64_t SlotChecksum(const HeaderSlot& slot) noexcept {
+    return serialization_detail::Checksum(&slot, offsetof(HeaderSlot, checksum));
+}
+
+inline bool IsValidSlot(const HeaderSlot& slot) noexcept {
+    return std::memcmp(slot.magic, kMagic, sizeof(kMagic)) == 0 && slot.checksum == SlotChecksum(slot);
+}
+
+inline size_t PageSize() noexcept {
+    static const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+}  // namespace mmap_vector_detail
+
+// Вектор, хранящийся в файле, отображённом через MAP_SHARED: после
+// перезапуска данные доступны сразу, а резидентностью управляет страничный
+// кэш. Рост — ftruncate и переотображение (итераторы при этом, как у
+// SimpleVector, становятся недействительными). Заголовок меняется только
+// в Sync: сначала сбрасываются данные и лишь затем пишется вторая копия
+// заголовка с новым размером, так что после сбоя вектор открывается в
+// последнем зафиксированном состоянии.
+template <typename Type>
+class MmapVector {
+    using HeaderSlot = mmap_vector_detail::HeaderSlot;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    MmapVector() noexcept = default;
+
+    // Открывает файл, создавая пустой вектор, если файла нет или он пуст.
+    explicit MmapVector(const std::string& path) {
+        static_assert(std::is_trivially_copyable_v<Type>, "MmapVector requires a trivially copyable type");
+        static_assert(alignof(Type) <= mmap_vector_detail::kDataOffset, "MmapVector element alignment is too large");
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            serialization_detail::ThrowErrno("open");
+        }
+        try {
+            Open();
+        }
+        catch (...) {
+            Close();
+            throw;
+        }
+    }
+
+    MmapVector(const MmapVector&) = delete;
+    MmapVector& operator=(const MmapVector&) = delete;
+
+    MmapVector(MmapVector&& other) noexcept {
+        swap(other);
+    }
+
+    MmapVector& operator=(MmapVector&& rhs) noexcept {
+        if (this != &rhs) {
+            MmapVector moved(std::move(rhs));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    // Фиксирует текущий размер через Sync; при ошибке сброса файл остаётся
+    // в предыдущем зафиксированном состоянии.
+    ~MmapVector() {
+        if (mapping_ != nullptr) {
+            try {
+                Sync();
+            }
+            catch (...) {
+            }
+        }
+        Close();
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    Type& At(size_t index) {
+        CheckIndex(index);
+        return Data()[index];
+    }
+
+    const Type& At(size_t index) const {
+        CheckIndex(index);
+        return Data()[index];
+    }
+
+    SimpleVectorView<Type> GetView() const noexcept {
+        return SimpleVectorView<Type>(Data(), size_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            Remap(new_capacity);
+        }
+    }
+
+    // Новые элементы заполняются нулями (так их отдаёт ftruncate) или Type{}.
+    void Resize(size_t new_size) {
+        if (new_size > capacity_) {
+            Remap(GrowCapacity(new_size));
+        }
+        if (new_size > size_) {
+            std::fill(Data() + size_, Data() + new_size, Type{});
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const Type& item) {
+        if (size_ == capacity_) {
+            Remap(GrowCapacity(size_ + 1));
+        }
+        Data()[size_++] = item;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+    }
+
+    void Clear() noexcept {
+        size_ = 0;
+    }
+
+    // Сбрасывает на диск страницы элементов [begin, end); заголовок не меняется.
+    void Flush(size_t begin, size_t end) {
+        assert(begin <= end && end <= capacity_);
+        if (begin == end) {
+            return;
+        }
+        const size_t page_size = mmap_vector_detail::PageSize();
+        const size_t first = (mmap_vector_detail::kDataOffset + begin * sizeof(Type)) / page_size * page_size;
+        const size_t last = mmap_vector_detail::kDataOffset + end * sizeof(Type);
+        if (::msync(static_cast<char*>(mapping_) + first, last - first, MS_SYNC) != 0) {
+            serialization_detail::ThrowErrno("msync");
+        }
+    }
+
+    // Фиксирует текущий размер: данные сбрасываются раньше заголовка.
+    void Sync() {
+        Flush(0, size_);
+        WriteHeader();
+        if (::msync(mapping_, mmap_vector_detail::kDataOffset, MS_SYNC) != 0) {
+            serialization_detail::ThrowErrno("msync");
+        }
+    }
+
+    void swap(MmapVector& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(mapping_, other.mapping_);
+        std::swap(mapping_size_, other.mapping_size_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(sequence_, other.sequence_);
+    }
+
+    Iterator begin() noexcept {
+        return Data();
+    }
+
+    Iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator end() const noexcept {
+        return Data() + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator cend() const noexcept {
+        return Data() + size_;
+    }
+
+private:
+    Type* Data() const noexcept {
+        return mapping_ == nullptr
+                   ? nullptr
+                   : reinterpret_cast<Type*>(static_cast<char*>(mapping_) + mmap_vector_detail::kDataOffset);
+    }
+
+    HeaderSlot* Slot(size_t index) const noexcept {
+        return reinterpret_cast<HeaderSlot*>(static_cast<char*>(mapping_) + index * mmap_vector_detail::kSlotStride);
+    }
+
+    void CheckIndex(size_t index) const {
+        if (index >= size_) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+    }
+
+    size_t GrowCapacity(size_t required) const noexcept {
+        const size_t minimum = std::max<size_t>(1, mmap_vector_detail::kMinGrowBytes / sizeof(Type));
+        return std::max({required, capacity_ * 2, minimum});
+    }
+
+    void Open() {
+        using namespace std::string_literals;
+        struct stat status;
+        if (::fstat(fd_, &status) != 0) {
+            serialization_detail::ThrowErrno("fstat");
+        }
+        if (status.st_size == 0) {
+            Remap(0);
+            Sync();
+            return;
+        }
+        if (static_cast<size_t>(status.st_size) < mmap_vector_detail::kDataOffset) {
+            throw std::runtime_error("Mmap vector file is too short"s);
+        }
+        capacity_ = (static_cast<size_t>(status.st_size) - mmap_vector_detail::kDataOffset) / sizeof(Type);
+        Map(static_cast<size_t>(status.st_size));
+        const HeaderSlot* current = nullptr;
+        for (size_t slot = 0; slot < 2; ++slot) {
+            if (mmap_vector_detail::IsValidSlot(*Slot(slot)) &&
+                (current == nullptr || Slot(slot)->sequence > current->sequence)) {
+                current = Slot(slot);
+            }
+        }
+        if (current == nullptr) {
+            throw std::runtime_error("Mmap vector file has no valid header"s);
+        }
+        if (current->version != mmap_vector_detail::kVersion ||
+            current->endianness != serialization_detail::kEndiannessMark ||
+            current->element_size != sizeof(Type) || current->type_tag != VectorTypeTag<Type>::value) {
+            throw std::runtime_error("Mmap vector file format mismatch"s);
+        }
+        if (current->count > capacity_) {
+            throw std::runtime_error("Mmap vector file is truncated"s);
+        }
+        size_ = current->count;
+        sequence_ = current->sequence;
+    }
+
+    // Новая копия заголовка пишется в слот, не занятый действующей.
+    void WriteHeader() noexcept {
+        HeaderSlot slot{};
+        std::memcpy(slot.magic, mmap_vector_detail::kMagic, sizeof(slot.magic));
+        slot.version = mmap_vector_detail::kVersion;
+        slot.endianness = serialization_detail::kEndiannessMark;
+        slot.type_tag = VectorTypeTag<Type>::value;
+        slot.element_size = sizeof(Type);
+        slot.sequence = ++sequence_;
+        slot.count = size_;
+        slot.checksum = mmap_vector_detail::SlotChecksum(slot);
+        std::memcpy(Slot(sequence_ % 2), &slot, sizeof(slot));
+    }
+
+    void Remap(size_t new_capacity) {
+        const size_t new_mapping_size = mmap_vector_detail::kDataOffset + new_capacity * sizeof(Type);
+        if (::ftruncate(fd_, static_cast<off_t>(new_mapping_size)) != 0) {
+            serialization_detail::ThrowErrno("ftruncate");
+        }
+#if defined(__linux__)
+        if (mapping_ != nullptr) {
+            void* mapping = ::mremap(mapping_, mapping_size_, new_mapping_size, MREMAP_MAYMOVE);
+            if (mapping == MAP_FAILED) {
+                serialization_detail::ThrowErrno("mremap");
+            }
+            mapping_ = mapping;
+            mapping_size_ = new_mapping_size;
+            capacity_ = new_capacity;
+            return;
+        }
+#endif
+        Unmap();
+        Map(new_mapping_size);
+        capacity_ = new_capacity;
+    }
+
+    void Map(size_t mapping_size) {
+        void* mapping = ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED) {
+            serialization_detail::ThrowErrno("mmap");
+        }
+        mapping_ = mapping;
+        mapping_size_ = mapping_size;
+    }
+
+    void Unmap() noexcept {
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, mapping_size_);
+        }
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+    }
+
+    void Close() noexcept {
+        Unmap();
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+    }
+
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    uint64_t sequence_ = 0;
+};
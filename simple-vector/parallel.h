@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "simple_vector.h"
+
+inline size_t DefaultThreadCount() noexcept {
+    const unsigned count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+// Выполняет function(task) для task из [0, task_count) на thread_count потоках,
+// включая вызывающий. Первое выброшенное исключение пробрасывается после
+// завершения всех потоков.
+template <typename Function>
+void ParallelFor(size_t task_count, size_t thread_count, Function function) {
+    thread_count = std::min(std::max<size_t>(thread_count, 1), task_count);
+    if (thread_count <= 1) {
+        for (size_t task = 0; task < task_count; ++task) {
+            function(task);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_task{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&]() {
+        try {
+            for (size_t task = next_task++; task < task_count; task = next_task++) {
+                function(task);
+            }
+        }
+        catch (...) {
+            std::lock_guard guard(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next_task = task_count;
+        }
+    };
+
+    SimpleVector<std::thread> threads;
+    threads.Reserve(thread_count - 1);
+    for (size_t i = 0; i + 1 < thread_count; ++i) {
+        threads.PushBack(std::thread(worker));
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Делит [0, size) на не более чем part_count почти равных частей.
+inline std::pair<size_t, size_t> SplitRange(size_t size, size_t part_count, size_t part) noexcept {
+    const size_t base = size / part_count;
+    const size_t extra = size % part_count;
+    const size_t begin = part * base + std::min(part, extra);
+    return {begin, begin + base + (part < extra ? 1 : 0)};
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+namespace permutation_detail {
+
+// Дистанция предвыборки в элементах: случайные обращения к src при больших
+// векторах упираются в промахи кэша, и их надо запрашивать заранее.
+constexpr size_t kPrefetchDistance = 16;
+
+template <typename Type>
+inline void PrefetchRead(const Type* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 1);
+#else
+    (void)address;
+#endif
+}
+
+template <typename Type>
+inline void PrefetchWrite(Type* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 1, 1);
+#else
+    (void)address;
+#endif
+}
+
+#if defined(__AVX2__)
+
+template <typename Type, typename Index>
+constexpr bool kHasAvx2Gather = sizeof(Type) == 4 && std::is_arithmetic_v<Type>
+    && std::is_integral_v<Index> && sizeof(Index) == 4;
+
+// Обрабатывает кратную восьми часть индексов, возвращает число обработанных.
+template <typename Type, typename Index>
+size_t GatherAvx2(const Type* src, const Index* indices, size_t size, Type* dst) noexcept {
+    const size_t blocks_size = size / 8 * 8;
+    const int* base = reinterpret_cast<const int*>(src);
+    for (size_t i = 0; i < blocks_size; i += 8) {
+        const __m256i offsets = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+        const __m256i values = _mm256_i32gather_epi32(base, offsets, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), values);
+    }
+    return blocks_size;
+}
+
+#endif
+
+}  // namespace permutation_detail
+
+// dst[i] = src[indices[i]]. Размер dst равен числу индексов.
+template <typename Type, typename Index>
+void Gather(SimpleVectorView<Type> src, SimpleVectorView<Index> indices, MutableSimpleVectorView<Type> dst) {
+    static_assert(std::is_integral_v<Index>, "Indices must be integral");
+    assert(dst.GetSize() == indices.GetSize());
+    const size_t size = indices.GetSize();
+    const Type* source = src.begin();
+    const Index* index = indices.begin();
+    Type* output = dst.begin();
+    size_t done = 0;
+#if defined(__AVX2__)
+    if constexpr (permutation_detail::kHasAvx2Gather<Type, Index>) {
+        assert(src.GetSize() <= static_cast<size_t>(INT32_MAX));
+#if !defined(NDEBUG)
+        // Векторная часть не проверяет индексы, поэтому в отладочной сборке
+        // они проверяются заранее, как в скалярном цикле.
+        for (size_t i = 0; i < size / 8 * 8; ++i) {
+            assert(static_cast<size_t>(index[i]) < src.GetSize());
+        }
+#endif
+        done = permutation_detail::GatherAvx2(source, index, size, output);
+    }
+#endif
+    for (size_t i = done; i < size; ++i) {
+        if (i + permutation_detail::kPrefetchDistance < size) {
+            permutation_detail::PrefetchRead(source + index[i + permutation_detail::kPrefetchDistance]);
+        }
+        assert(static_cast<size_t>(index[i]) < src.GetSize());
+        output[i] = source[index[i]];
+    }
+}
+
+// Буфер dst переиспользуется.
+template <typename Type, typename Index>
+void Gather(const SimpleVector<Type>& src, const SimpleVector<Index>& indices, SimpleVector<Type>& dst) {
+    dst.Resize(indices.GetSize());
+    Gather(SimpleVectorView<Type>(src), SimpleVectorView<Index>(indices), MutableSimpleVectorView<Type>(dst));
+}
+
+template <typename Type, typename Index>
+SimpleVector<Type> Gather(SimpleVectorView<Type> src, SimpleVectorView<Index> indices) {
+    SimpleVector<Type> dst(indices.GetSize());
+    Gather(src, indices, MutableSimpleVectorView<Type>(dst));
+    return dst;
+}
+
+template <typename Type, typename Index>
+SimpleVector<Type> Gather(const SimpleVector<Type>& src, const SimpleVector<Index>& indices) {
+    return Gather(SimpleVectorView<Type>(src), SimpleVectorView<Index>(indices));
+}
+
+// dst[indices[i]] = src[i]. Размер dst должен покрывать все индексы.
+template <typename Type, typename Index>
+void Scatter(SimpleVectorView<Type> src, SimpleVectorView<Index> indices, MutableSimpleVectorView<Type> dst) {
+    static_assert(std::is_integral_v<Index>, "Indices must be integral");
+    assert(src.GetSize() == indices.GetSize());
+    const size_t size = indices.GetSize();
+    const Type* source = src.begin();
+    const Index* index = indices.begin();
+    Type* output = dst.begin();
+    for (size_t i = 0; i < size; ++i) {
+        if (i + permutation_detail::kPrefetchDistance < size) {
+            permutation_detail::PrefetchWrite(output + index[i + permutation_detail::kPrefetchDistance]);
+        }
+        assert(static_cast<size_t>(index[i]) < dst.GetSize());
+        output[index[i]] = source[i];
+    }
+}
+
+template <typename Type, typename Index>
+void Scatter(const SimpleVector<Type>& src, const SimpleVector<Index>& indices, SimpleVector<Type>& dst) {
+    Scatter(SimpleVectorView<Type>(src), SimpleVectorView<Index>(indices), MutableSimpleVectorView<Type>(dst));
+}
+
+// Переставляет values на месте так, что новый values[i] равен старому
+// values[permutation[i]] (как Gather). Обходит циклы перестановки, отмечая
+// пройденные позиции в битовом векторе, поэтому каждый элемент перемещается
+// ровно один раз и дополнительная память — n бит. Если permutation не
+// перестановка (индекс вне диапазона или повтор), бросает
+// std::invalid_argument, не трогая values.
+template <typename Type, typename Index>
+void ApplyPermutation(MutableSimpleVectorView<Type> values, SimpleVectorView<Index> permutation) {
+    static_assert(std::is_integral_v<Index>, "Indices must be integral");
+    using namespace std::string_literals;
+    if (values.GetSize() != permutation.GetSize()) {
+        throw std::invalid_argument("Permutation size does not match values"s);
+    }
+    const size_t size = values.GetSize();
+    SimpleVector<uint64_t> visited((size + 63) / 64);
+    auto mark = [&visited](size_t index) {
+        visited[index / 64] |= uint64_t{1} << (index % 64);
+    };
+    auto is_marked = [&visited](size_t index) {
+        return (visited[index / 64] >> (index % 64)) & 1;
+    };
+    // Проверка до первого перемещения: каждый индекс встречается ровно раз.
+    for (size_t i = 0; i < size; ++i) {
+        const size_t index = static_cast<size_t>(permutation[i]);
+        if (index >= size || is_marked(index)) {
+            throw std::invalid_argument("Not a permutation"s);
+        }
+        mark(index);
+    }
+    std::fill(visited.begin(), visited.end(), uint64_t{0});
+    for (size_t start = 0; start < size; ++start) {
+        if (is_marked(start)) {
+            continue;
+        }
+        mark(start);
+        size_t current = start;
+        size_t next = static_cast<size_t>(permutation[current]);
+        if (next == start) {
+            continue;
+        }
+        Type carried = std::move(values[start]);
+        while (next != start) {
+            assert(!is_marked(next));
+            values[current] = std::move(values[next]);
+            current = next;
+            mark(current);
+            next = static_cast<size_t>(permutation[current]);
+        }
+        values[current] = std::move(carried);
+    }
+}
+
+template <typename Type, typename Index>
+void ApplyPermutation(SimpleVector<Type>& values, const SimpleVector<Index>& permutation) {
+    ApplyPermutation(MutableSimpleVectorView<Type>(values), SimpleVectorView<Index>(permutation));
+}
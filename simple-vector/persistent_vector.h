@@ -0,0 +1,375 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "simple_vector.h"
+
+namespace persistent_vector_detail {
+
+constexpr unsigned kBits = 5;
+constexpr size_t kWidth = size_t{1} << kBits;
+constexpr size_t kMask = kWidth - 1;
+
+inline uint64_t NewEditToken() noexcept {
+    static std::atomic<uint64_t> next_token{1};
+    return next_token++;
+}
+
+}  // namespace persistent_vector_detail
+
+// Неизменяемый вектор на 32-арном префиксном дереве с хвостом: PushBack,
+// Set и PopBack возвращают новую версию за O(log32 n), разделяя с исходной
+// все нетронутые узлы. Копирование версии — O(1), узлы освобождаются
+// атомарным счётчиком ссылок, поэтому версии можно раздавать читателям в
+// других потоках. Для пакетных правок есть Transient: он меняет на месте
+// узлы, созданные им самим, и копирует только чужие.
+template <typename Type>
+class PersistentVector {
+    static constexpr unsigned kBits = persistent_vector_detail::kBits;
+    static constexpr size_t kWidth = persistent_vector_detail::kWidth;
+    static constexpr size_t kMask = persistent_vector_detail::kMask;
+
+    // owner — маркер правки, создавшей узел; 0 у узлов неизменяемых версий.
+    struct Node {
+        uint64_t owner = 0;
+    };
+
+    struct Leaf : Node {
+        Type values[kWidth]{};
+    };
+
+    struct Branch : Node {
+        std::shared_ptr<Node> children[kWidth];
+    };
+
+    struct State {
+        size_t size = 0;
+        unsigned shift = kBits;
+        std::shared_ptr<Branch> root;
+        std::shared_ptr<Leaf> tail;
+    };
+
+public:
+    // Transient нельзя копировать: копии делили бы маркер правки и меняли
+    // узлы друг друга на месте. После перемещения исходный Transient пуст и
+    // получает свой маркер.
+    class Transient {
+    public:
+        Transient(const Transient&) = delete;
+        Transient& operator=(const Transient&) = delete;
+
+        Transient(Transient&& other) noexcept
+            : state_(std::exchange(other.state_, State{})),
+              token_(std::exchange(other.token_, persistent_vector_detail::NewEditToken())) {
+        }
+
+        Transient& operator=(Transient&& other) noexcept {
+            if (this != &other) {
+                state_ = std::exchange(other.state_, State{});
+                token_ = std::exchange(other.token_, persistent_vector_detail::NewEditToken());
+            }
+            return *this;
+        }
+
+        size_t GetSize() const noexcept {
+            return state_.size;
+        }
+
+        const Type& operator[](size_t index) const noexcept {
+            assert(index < state_.size);
+            return LeafFor(state_, index)->values[index & kMask];
+        }
+
+        Transient& PushBack(Type value) {
+            DoPushBack(state_, std::move(value), token_);
+            return *this;
+        }
+
+        Transient& Set(size_t index, Type value) {
+            assert(index < state_.size);
+            DoSet(state_, index, std::move(value), token_);
+            return *this;
+        }
+
+        Transient& PopBack() {
+            assert(state_.size > 0);
+            DoPopBack(state_, token_);
+            return *this;
+        }
+
+        // Фиксирует текущее состояние как неизменяемую версию. Дальнейшие
+        // правки через этот Transient её не затронут.
+        PersistentVector Persistent() {
+            token_ = persistent_vector_detail::NewEditToken();
+            return PersistentVector(state_);
+        }
+
+    private:
+        friend class PersistentVector;
+
+        explicit Transient(const State& state) : state_(state), token_(persistent_vector_detail::NewEditToken()) {
+        }
+
+        State state_;
+        uint64_t token_;
+    };
+
+    PersistentVector() noexcept = default;
+
+    explicit PersistentVector(const SimpleVector<Type>& values) {
+        Transient transient = AsTransient();
+        for (const Type& value : values) {
+            transient.PushBack(value);
+        }
+        *this = transient.Persistent();
+    }
+
+    size_t GetSize() const noexcept {
+        return state_.size;
+    }
+
+    bool IsEmpty() const noexcept {
+        return state_.size == 0;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < state_.size);
+        return LeafFor(state_, index)->values[index & kMask];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= state_.size) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+        return (*this)[index];
+    }
+
+    [[nodiscard]] PersistentVector PushBack(Type value) const {
+        State state = state_;
+        DoPushBack(state, std::move(value), 0);
+        return PersistentVector(state);
+    }
+
+    [[nodiscard]] PersistentVector Set(size_t index, Type value) const {
+        assert(index < state_.size);
+        State state = state_;
+        DoSet(state, index, std::move(value), 0);
+        return PersistentVector(state);
+    }
+
+    [[nodiscard]] PersistentVector PopBack() const {
+        assert(state_.size > 0);
+        State state = state_;
+        DoPopBack(state, 0);
+        return PersistentVector(state);
+    }
+
+    Transient AsTransient() const {
+        return Transient(state_);
+    }
+
+    // Обход по листам: один спуск по дереву на 32 элемента.
+    template <typename Function>
+    void ForEach(Function function) const {
+        for (size_t begin = 0; begin < state_.size; begin += kWidth) {
+            const Leaf* leaf = LeafFor(state_, begin);
+            const size_t count = std::min(kWidth, state_.size - begin);
+            for (size_t offset = 0; offset < count; ++offset) {
+                function(leaf->values[offset]);
+            }
+        }
+    }
+
+    SimpleVector<Type> ToSimpleVector() const {
+        SimpleVector<Type> result;
+        result.Reserve(state_.size);
+        ForEach([&result](const Type& value) {
+            result.PushBack(value);
+        });
+        return result;
+    }
+
+private:
+    explicit PersistentVector(const State& state) : state_(state) {
+    }
+
+    static size_t TailOffset(size_t size) noexcept {
+        return size < kWidth ? 0 : ((size - 1) >> kBits) << kBits;
+    }
+
+    static const Leaf* LeafFor(const State& state, size_t index) noexcept {
+        if (index >= TailOffset(state.size)) {
+            return state.tail.get();
+        }
+        const Node* node = state.root.get();
+        for (unsigned level = state.shift; level > 0; level -= kBits) {
+            node = static_cast<const Branch*>(node)->children[(index >> level) & kMask].get();
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    // Узел можно менять на месте, только если его создала текущая правка.
+    template <typename NodeType>
+    static std::shared_ptr<NodeType> Editable(const std::shared_ptr<NodeType>& node, uint64_t token) {
+        if (token != 0 && node->owner == token) {
+            return node;
+        }
+        auto copy = std::make_shared<NodeType>(*node);
+        copy->owner = token;
+        return copy;
+    }
+
+    template <typename NodeType>
+    static std::shared_ptr<NodeType> MakeNode(uint64_t token) {
+        auto node = std::make_shared<NodeType>();
+        node->owner = token;
+        return node;
+    }
+
+    static std::shared_ptr<Node> NewPath(unsigned level, std::shared_ptr<Node> node, uint64_t token) {
+        if (level == 0) {
+            return node;
+        }
+        auto branch = MakeNode<Branch>(token);
+        branch->children[0] = NewPath(level - kBits, std::move(node), token);
+        return branch;
+    }
+
+    static std::shared_ptr<Branch> PushTail(size_t size, unsigned level, const std::shared_ptr<Branch>& parent,
+                                            std::shared_ptr<Node> tail, uint64_t token) {
+        auto result = Editable(parent, token);
+        const size_t sub_index = ((size - 1) >> level) & kMask;
+        if (level == kBits) {
+            result->children[sub_index] = std::move(tail);
+        }
+        else if (result->children[sub_index]) {
+            result->children[sub_index] = PushTail(size, level - kBits,
+                                                   std::static_pointer_cast<Branch>(result->children[sub_index]),
+                                                   std::move(tail), token);
+        }
+        else {
+            result->children[sub_index] = NewPath(level - kBits, std::move(tail), token);
+        }
+        return result;
+    }
+
+    static void DoPushBack(State& state, Type&& value, uint64_t token) {
+        const size_t tail_size = state.size - TailOffset(state.size);
+        if (tail_size < kWidth) {
+            state.tail = state.tail ? Editable(state.tail, token) : MakeNode<Leaf>(token);
+            state.tail->values[tail_size] = std::move(value);
+            ++state.size;
+            return;
+        }
+        std::shared_ptr<Node> full_tail = std::move(state.tail);
+        if (!state.root) {
+            state.root = MakeNode<Branch>(token);
+            state.root->children[0] = std::move(full_tail);
+            state.shift = kBits;
+        }
+        else if ((state.size >> kBits) > (size_t{1} << state.shift)) {
+            auto new_root = MakeNode<Branch>(token);
+            new_root->children[0] = state.root;
+            new_root->children[1] = NewPath(state.shift, std::move(full_tail), token);
+            state.root = std::move(new_root);
+            state.shift += kBits;
+        }
+        else {
+            state.root = PushTail(state.size, state.shift, state.root, std::move(full_tail), token);
+        }
+        state.tail = MakeNode<Leaf>(token);
+        state.tail->values[0] = std::move(value);
+        ++state.size;
+    }
+
+    static std::shared_ptr<Branch> Assoc(unsigned level, const std::shared_ptr<Branch>& node, size_t index,
+                                         Type&& value, uint64_t token) {
+        auto result = Editable(node, token);
+        const size_t sub_index = (index >> level) & kMask;
+        if (level == kBits) {
+            auto leaf = Editable(std::static_pointer_cast<Leaf>(result->children[sub_index]), token);
+            leaf->values[index & kMask] = std::move(value);
+            result->children[sub_index] = std::move(leaf);
+        }
+        else {
+            result->children[sub_index] = Assoc(level - kBits,
+                                                std::static_pointer_cast<Branch>(result->children[sub_index]), index,
+                                                std::move(value), token);
+        }
+        return result;
+    }
+
+    static void DoSet(State& state, size_t index, Type&& value, uint64_t token) {
+        if (index >= TailOffset(state.size)) {
+            state.tail = Editable(state.tail, token);
+            state.tail->values[index & kMask] = std::move(value);
+            return;
+        }
+        state.root = Assoc(state.shift, state.root, index, std::move(value), token);
+    }
+
+    static std::shared_ptr<Leaf> LeafPointerFor(const State& state, size_t index) {
+        std::shared_ptr<Node> node = state.root;
+        for (unsigned level = state.shift; level > 0; level -= kBits) {
+            node = static_cast<const Branch*>(node.get())->children[(index >> level) & kMask];
+        }
+        return std::static_pointer_cast<Leaf>(node);
+    }
+
+    // Убирает из дерева последний лист; пустые ветви не сохраняются.
+    static std::shared_ptr<Branch> PopTail(size_t size, unsigned level, const std::shared_ptr<Branch>& node,
+                                           uint64_t token) {
+        const size_t sub_index = ((size - 2) >> level) & kMask;
+        if (level > kBits) {
+            auto child = PopTail(size, level - kBits, std::static_pointer_cast<Branch>(node->children[sub_index]),
+                                 token);
+            if (!child && sub_index == 0) {
+                return nullptr;
+            }
+            auto result = Editable(node, token);
+            result->children[sub_index] = std::move(child);
+            return result;
+        }
+        if (sub_index == 0) {
+            return nullptr;
+        }
+        auto result = Editable(node, token);
+        result->children[sub_index] = nullptr;
+        return result;
+    }
+
+    static void DoPopBack(State& state, uint64_t token) {
+        if (state.size == 1) {
+            state = State{};
+            return;
+        }
+        const size_t tail_size = state.size - TailOffset(state.size);
+        if (tail_size > 1) {
+            state.tail = Editable(state.tail, token);
+            state.tail->values[tail_size - 1] = Type{};
+            --state.size;
+            return;
+        }
+        state.tail = LeafPointerFor(state, state.size - 2);
+        auto new_root = PopTail(state.size, state.shift, state.root, token);
+        if (new_root && state.shift > kBits && !new_root->children[1]) {
+            new_root = std::static_pointer_cast<Branch>(new_root->children[0]);
+            state.shift -= kBits;
+        }
+        if (!new_root) {
+            state.shift = kBits;
+        }
+        state.root = std::move(new_root);
+        --state.size;
+    }
+
+    State state_;
+};
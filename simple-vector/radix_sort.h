@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+namespace radix_sort_detail {
+
+constexpr size_t kRadix = 256;
+
+// Беззнаковое представление, сохраняющее порядок: у знаковых типов
+// инвертируется старший бит.
+template <typename Type>
+std::make_unsigned_t<Type> SortableBits(Type value) noexcept {
+    using Bits = std::make_unsigned_t<Type>;
+    Bits bits = static_cast<Bits>(value);
+    if constexpr (std::is_signed_v<Type>) {
+        bits ^= Bits{1} << (std::numeric_limits<Bits>::digits - 1);
+    }
+    return bits;
+}
+
+// Устойчивая LSD-сортировка по байтам. Гистограммы всех разрядов строятся за
+// один проход; разряд, по которому все ключи совпадают, пропускается.
+// Если indices не nullptr, индексы переставляются вместе с ключами.
+template <typename Bits>
+void SortBits(SimpleVector<Bits>& keys, SimpleVector<size_t>* indices) {
+    constexpr size_t kDigits = sizeof(Bits);
+    const size_t size = keys.GetSize();
+    SimpleVector<size_t> histograms(kDigits * kRadix);
+    for (Bits key : keys) {
+        for (size_t digit = 0; digit < kDigits; ++digit) {
+            ++histograms[digit * kRadix + ((key >> (digit * 8)) & 0xFF)];
+        }
+    }
+
+    SimpleVector<Bits> key_buffer(size);
+    SimpleVector<size_t> index_buffer(indices != nullptr ? size : 0);
+    for (size_t digit = 0; digit < kDigits; ++digit) {
+        size_t* counts = histograms.begin() + digit * kRadix;
+        const Bits first_digit = size == 0 ? 0 : static_cast<Bits>((keys[0] >> (digit * 8)) & 0xFF);
+        if (counts[first_digit] == size) {
+            continue;
+        }
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < kRadix; ++bucket) {
+            const size_t count = counts[bucket];
+            counts[bucket] = offset;
+            offset += count;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            const size_t position = counts[(keys[i] >> (digit * 8)) & 0xFF]++;
+            key_buffer[position] = keys[i];
+            if (indices != nullptr) {
+                index_buffer[position] = (*indices)[i];
+            }
+        }
+        keys.swap(key_buffer);
+        if (indices != nullptr) {
+            indices->swap(index_buffer);
+        }
+    }
+}
+
+}  // namespace radix_sort_detail
+
+// Сортировка целых по возрастанию за O(n * sizeof(Type)).
+template <typename Type>
+void RadixSort(MutableSimpleVectorView<Type> values) {
+    static_assert(std::is_integral_v<Type> && !std::is_same_v<Type, bool>, "RadixSort requires an integral type");
+    using Bits = std::make_unsigned_t<Type>;
+    SimpleVector<Bits> keys(values.GetSize());
+    for (size_t i = 0; i < values.GetSize(); ++i) {
+        keys[i] = radix_sort_detail::SortableBits(values[i]);
+    }
+    radix_sort_detail::SortBits(keys, nullptr);
+    for (size_t i = 0; i < values.GetSize(); ++i) {
+        values[i] = static_cast<Type>(radix_sort_detail::SortableBits(static_cast<Type>(keys[i])));
+    }
+}
+
+template <typename Type>
+void RadixSort(SimpleVector<Type>& values) {
+    RadixSort(MutableSimpleVectorView<Type>(values));
+}
+
+// Устойчивая перестановка, упорядочивающая values по возрастанию:
+// values[result[0]] <= values[result[1]] <= ..., равные — по возрастанию индекса.
+template <typename Type>
+SimpleVector<size_t> RadixSortIndices(SimpleVectorView<Type> values) {
+    static_assert(std::is_integral_v<Type> && !std::is_same_v<Type, bool>, "RadixSort requires an integral type");
+    using Bits = std::make_unsigned_t<Type>;
+    SimpleVector<Bits> keys(values.GetSize());
+    SimpleVector<size_t> indices(values.GetSize());
+    for (size_t i = 0; i < values.GetSize(); ++i) {
+        keys[i] = radix_sort_detail::SortableBits(values[i]);
+        indices[i] = i;
+    }
+    radix_sort_detail::SortBits(keys, &indices);
+    return indices;
+}
+
+template <typename Type>
+SimpleVector<size_t> RadixSortIndices(const SimpleVector<Type>& values) {
+    return RadixSortIndices(SimpleVectorView<Type>(values));
+}
+
+template <typename Type>
+SimpleVector<size_t> RadixSortIndices(MutableSimpleVectorView<Type> values) {
+    return RadixSortIndices(SimpleVectorView<Type>(values));
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+template <typename Type>
+struct SumMonoid {
+    Type Identity() const {
+        return Type{};
+    }
+
+    Type operator()(const Type& lhs, const Type& rhs) const {
+        return lhs + rhs;
+    }
+};
+
+template <typename Type>
+struct MinMonoid {
+    Type Identity() const {
+        return std::numeric_limits<Type>::max();
+    }
+
+    Type operator()(const Type& lhs, const Type& rhs) const {
+        return std::min(lhs, rhs);
+    }
+};
+
+template <typename Type>
+struct MaxMonoid {
+    Type Identity() const {
+        return std::numeric_limits<Type>::lowest();
+    }
+
+    Type operator()(const Type& lhs, const Type& rhs) const {
+        return std::max(lhs, rhs);
+    }
+};
+
+// Дерево Фенвика для сумм: точечное изменение и сумма на отрезке за O(log n).
+// Все отрезки полуоткрытые: [begin, end).
+template <typename Type>
+class FenwickTree {
+public:
+    FenwickTree() = default;
+
+    explicit FenwickTree(size_t size) : tree_(size + 1) {
+    }
+
+    // Построение за O(n): каждый узел передаёт накопленную сумму родителю.
+    explicit FenwickTree(SimpleVectorView<Type> values) : tree_(values.GetSize() + 1) {
+        const size_t size = values.GetSize();
+        for (size_t index = 1; index <= size; ++index) {
+            tree_[index] += values[index - 1];
+            const size_t parent = index + (index & (~index + 1));
+            if (parent <= size) {
+                tree_[parent] += tree_[index];
+            }
+        }
+    }
+
+    explicit FenwickTree(const SimpleVector<Type>& values) : FenwickTree(SimpleVectorView<Type>(values)) {
+    }
+
+    size_t GetSize() const noexcept {
+        return tree_.IsEmpty() ? 0 : tree_.GetSize() - 1;
+    }
+
+    void Add(size_t index, const Type& delta) {
+        assert(index < GetSize());
+        for (size_t node = index + 1; node < tree_.GetSize(); node += node & (~node + 1)) {
+            tree_[node] += delta;
+        }
+    }
+
+    void Set(size_t index, const Type& value) {
+        Add(index, value - Get(index));
+    }
+
+    Type Get(size_t index) const {
+        return RangeSum(index, index + 1);
+    }
+
+    // Сумма первых end элементов.
+    Type PrefixSum(size_t end) const {
+        assert(end <= GetSize());
+        Type sum{};
+        for (size_t node = end; node > 0; node &= node - 1) {
+            sum += tree_[node];
+        }
+        return sum;
+    }
+
+    Type RangeSum(size_t begin, size_t end) const {
+        assert(begin <= end);
+        return PrefixSum(end) - PrefixSum(begin);
+    }
+
+private:
+    SimpleVector<Type> tree_;
+};
+
+// Нерекурсивное дерево отрезков снизу вверх для произвольного моноида
+// (минимум, максимум, сумма или свой). Листья лежат в nodes_[n, 2n), узел i
+// объединяет 2i и 2i + 1. Операция не обязана быть коммутативной: левая и
+// правая части запроса накапливаются отдельно.
+template <typename Type, typename Monoid>
+class SegmentTree {
+public:
+    SegmentTree() = default;
+
+    explicit SegmentTree(SimpleVectorView<Type> values, Monoid monoid = Monoid{})
+        : size_(values.GetSize()), nodes_(2 * values.GetSize()), monoid_(monoid) {
+        std::copy(values.begin(), values.end(), nodes_.begin() + size_);
+        for (size_t node = size_; node > 1; --node) {
+            nodes_[node - 1] = monoid_(nodes_[2 * (node - 1)], nodes_[2 * (node - 1) + 1]);
+        }
+    }
+
+    explicit SegmentTree(const SimpleVector<Type>& values, Monoid monoid = Monoid{})
+        : SegmentTree(SimpleVectorView<Type>(values), monoid) {
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    const Type& Get(size_t index) const noexcept {
+        assert(index < size_);
+        return nodes_[size_ + index];
+    }
+
+    void Set(size_t index, const Type& value) {
+        assert(index < size_);
+        size_t node = size_ + index;
+        nodes_[node] = value;
+        for (node /= 2; node > 0; node /= 2) {
+            nodes_[node] = monoid_(nodes_[2 * node], nodes_[2 * node + 1]);
+        }
+    }
+
+    Type Query(size_t begin, size_t end) const {
+        assert(begin <= end && end <= size_);
+        Type left = monoid_.Identity();
+        Type right = monoid_.Identity();
+        for (begin += size_, end += size_; begin < end; begin /= 2, end /= 2) {
+            if (begin & 1) {
+                left = monoid_(left, nodes_[begin++]);
+            }
+            if (end & 1) {
+                right = monoid_(nodes_[--end], right);
+            }
+        }
+        return monoid_(left, right);
+    }
+
+private:
+    size_t size_ = 0;
+    SimpleVector<Type> nodes_;
+    Monoid monoid_;
+};
+
+template <typename Type>
+using MinSegmentTree = SegmentTree<Type, MinMonoid<Type>>;
+
+template <typename Type>
+using MaxSegmentTree = SegmentTree<Type, MaxMonoid<Type>>;
+
+template <typename Type>
+using SumSegmentTree = SegmentTree<Type, SumMonoid<Type>>;
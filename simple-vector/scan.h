@@ -0,0 +1,300 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "parallel.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+namespace scan_detail {
+
+// Меньшие куски не окупают запуск потоков и второй проход по памяти.
+constexpr size_t kMinParallelChunk = size_t{1} << 16;
+
+#if defined(__AVX2__)
+
+template <typename Type, typename = void>
+struct Avx2Scan {
+    static constexpr bool kEnabled = false;
+};
+
+template <typename Type>
+struct Avx2Scan<Type, std::enable_if_t<std::is_integral_v<Type> && sizeof(Type) == 4>> {
+    static constexpr bool kEnabled = true;
+    static constexpr size_t kLanes = 8;
+    using Register = __m256i;
+
+    static Register Load(const Type* data) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    }
+    static void Store(Type* data, Register value) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), value);
+    }
+    static Register Broadcast(Type value) noexcept {
+        return _mm256_set1_epi32(static_cast<int32_t>(value));
+    }
+    static Register Add(Register lhs, Register rhs) noexcept {
+        return _mm256_add_epi32(lhs, rhs);
+    }
+    // Префиксная сумма внутри регистра: сдвиги в пределах 128-битных половин,
+    // затем перенос итога младшей половины в старшую.
+    static Register ScanInRegister(Register x) noexcept {
+        x = Add(x, _mm256_slli_si256(x, 4));
+        x = Add(x, _mm256_slli_si256(x, 8));
+        const Register low_total = _mm256_shuffle_epi32(x, 0xFF);
+        return Add(x, _mm256_permute2x128_si256(low_total, low_total, 0x08));
+    }
+    static Register ShiftInZero(Register x) noexcept {
+        const Register shifted = _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+        return _mm256_blend_epi32(shifted, _mm256_setzero_si256(), 0x01);
+    }
+    static Register BroadcastLast(Register x) noexcept {
+        return _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7));
+    }
+    static Type Extract(Register x) noexcept {
+        return static_cast<Type>(_mm256_cvtsi256_si32(x));
+    }
+};
+
+template <typename Type>
+struct Avx2Scan<Type, std::enable_if_t<std::is_integral_v<Type> && sizeof(Type) == 8>> {
+    static constexpr bool kEnabled = true;
+    static constexpr size_t kLanes = 4;
+    using Register = __m256i;
+
+    static Register Load(const Type* data) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    }
+    static void Store(Type* data, Register value) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), value);
+    }
+    static Register Broadcast(Type value) noexcept {
+        return _mm256_set1_epi64x(static_cast<long long>(value));
+    }
+    static Register Add(Register lhs, Register rhs) noexcept {
+        return _mm256_add_epi64(lhs, rhs);
+    }
+    static Register ScanInRegister(Register x) noexcept {
+        x = Add(x, _mm256_slli_si256(x, 8));
+        const Register low_total = _mm256_shuffle_epi32(x, 0xEE);
+        return Add(x, _mm256_permute2x128_si256(low_total, low_total, 0x08));
+    }
+    static Register ShiftInZero(Register x) noexcept {
+        return _mm256_blend_epi32(_mm256_permute4x64_epi64(x, 0x90), _mm256_setzero_si256(), 0x03);
+    }
+    static Register BroadcastLast(Register x) noexcept {
+        return _mm256_permute4x64_epi64(x, 0xFF);
+    }
+    static Type Extract(Register x) noexcept {
+        return static_cast<Type>(_mm256_extract_epi64(x, 0));
+    }
+};
+
+template <>
+struct Avx2Scan<float> {
+    static constexpr bool kEnabled = true;
+    static constexpr size_t kLanes = 8;
+    using Register = __m256;
+
+    static Register Load(const float* data) noexcept {
+        return _mm256_loadu_ps(data);
+    }
+    static void Store(float* data, Register value) noexcept {
+        _mm256_storeu_ps(data, value);
+    }
+    static Register Broadcast(float value) noexcept {
+        return _mm256_set1_ps(value);
+    }
+    static Register Add(Register lhs, Register rhs) noexcept {
+        return _mm256_add_ps(lhs, rhs);
+    }
+    static Register ScanInRegister(Register x) noexcept {
+        x = Add(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 4)));
+        x = Add(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 8)));
+        const Register low_total = _mm256_permute_ps(x, 0xFF);
+        return Add(x, _mm256_permute2f128_ps(low_total, low_total, 0x08));
+    }
+    static Register ShiftInZero(Register x) noexcept {
+        const Register shifted = _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+        return _mm256_blend_ps(shifted, _mm256_setzero_ps(), 0x01);
+    }
+    static Register BroadcastLast(Register x) noexcept {
+        return _mm256_permutevar8x32_ps(x, _mm256_set1_epi32(7));
+    }
+    static float Extract(Register x) noexcept {
+        return _mm256_cvtss_f32(x);
+    }
+};
+
+#endif
+
+// Сканирует data на месте, начиная с carry, и возвращает сумму carry и всех
+// элементов.
+template <bool Inclusive, typename Type>
+Type ScanRange(Type* data, size_t size, Type carry) noexcept {
+    size_t index = 0;
+#if defined(__AVX2__)
+    using Kernel = Avx2Scan<Type>;
+    if constexpr (Kernel::kEnabled) {
+        auto carry_register = Kernel::Broadcast(carry);
+        for (; index + Kernel::kLanes <= size; index += Kernel::kLanes) {
+            const auto block = Kernel::Load(data + index);
+            if constexpr (Inclusive) {
+                const auto scanned = Kernel::Add(Kernel::ScanInRegister(block), carry_register);
+                Kernel::Store(data + index, scanned);
+                carry_register = Kernel::BroadcastLast(scanned);
+            }
+            else {
+                const auto scanned = Kernel::Add(Kernel::ScanInRegister(Kernel::ShiftInZero(block)), carry_register);
+                Kernel::Store(data + index, scanned);
+                carry_register = Kernel::Add(Kernel::BroadcastLast(scanned), Kernel::BroadcastLast(block));
+            }
+        }
+        carry = Kernel::Extract(carry_register);
+    }
+#endif
+    for (; index < size; ++index) {
+        const Type value = data[index];
+        if constexpr (Inclusive) {
+            carry += value;
+            data[index] = carry;
+        }
+        else {
+            data[index] = carry;
+            carry += value;
+        }
+    }
+    return carry;
+}
+
+template <typename Type>
+Type SumRange(const Type* data, size_t size) noexcept {
+    Type sum{};
+    for (size_t index = 0; index < size; ++index) {
+        sum += data[index];
+    }
+    return sum;
+}
+
+// Двухпроходный параллельный скан: суммы кусков, их последовательный скан,
+// затем скан каждого куска со своим смещением.
+template <bool Inclusive, typename Type>
+Type ScanVector(MutableSimpleVectorView<Type> values, size_t thread_count) {
+    static_assert(std::is_arithmetic_v<Type>, "Scan requires an arithmetic type");
+    const size_t size = values.GetSize();
+    Type* data = values.begin();
+    const size_t part_count = std::min(thread_count, size / kMinParallelChunk);
+    if (part_count <= 1) {
+        return ScanRange<Inclusive>(data, size, Type{});
+    }
+
+    SimpleVector<Type> offsets(part_count);
+    ParallelFor(part_count, part_count, [&](size_t part) {
+        const auto [begin, end] = SplitRange(size, part_count, part);
+        offsets[part] = SumRange(data + begin, end - begin);
+    });
+    const Type total = ScanRange<false>(offsets.begin(), part_count, Type{});
+    ParallelFor(part_count, part_count, [&](size_t part) {
+        const auto [begin, end] = SplitRange(size, part_count, part);
+        ScanRange<Inclusive>(data + begin, end - begin, offsets[part]);
+    });
+    return total;
+}
+
+template <typename Type>
+struct SegmentCarry {
+    Type sum{};
+    bool has_head = false;
+};
+
+// heads[i] отмечает начало нового сегмента.
+template <typename Type>
+SegmentCarry<Type> SegmentedScanRange(Type* data, const bool* heads, size_t size, Type carry) noexcept {
+    bool has_head = false;
+    for (size_t index = 0; index < size; ++index) {
+        has_head |= heads[index];
+        carry = data[index] + (heads[index] ? Type{} : carry);
+        data[index] = carry;
+    }
+    return {carry, has_head};
+}
+
+template <typename Type>
+SegmentCarry<Type> SegmentedSumRange(const Type* data, const bool* heads, size_t size) noexcept {
+    SegmentCarry<Type> result;
+    for (size_t index = 0; index < size; ++index) {
+        result.has_head |= heads[index];
+        result.sum = data[index] + (heads[index] ? Type{} : result.sum);
+    }
+    return result;
+}
+
+}  // namespace scan_detail
+
+// Все сканы работают на месте и возвращают сумму всех элементов. При
+// thread_count > 1 большие векторы обрабатываются двухпроходным
+// параллельным алгоритмом; при сборке с AVX2 кускам int32/int64/float
+// соответствует скан внутри регистров.
+template <typename Type>
+Type InclusiveScan(MutableSimpleVectorView<Type> values, size_t thread_count = 1) {
+    return scan_detail::ScanVector<true>(values, thread_count);
+}
+
+template <typename Type>
+Type InclusiveScan(SimpleVector<Type>& values, size_t thread_count = 1) {
+    return InclusiveScan(MutableSimpleVectorView<Type>(values), thread_count);
+}
+
+template <typename Type>
+Type ExclusiveScan(MutableSimpleVectorView<Type> values, size_t thread_count = 1) {
+    return scan_detail::ScanVector<false>(values, thread_count);
+}
+
+template <typename Type>
+Type ExclusiveScan(SimpleVector<Type>& values, size_t thread_count = 1) {
+    return ExclusiveScan(MutableSimpleVectorView<Type>(values), thread_count);
+}
+
+// Сегментированный включающий скан: сумма накапливается от ближайшей
+// позиции i, где heads[i] == true.
+template <typename Type>
+void SegmentedInclusiveScan(MutableSimpleVectorView<Type> values, SimpleVectorView<bool> heads,
+                            size_t thread_count = 1) {
+    static_assert(std::is_arithmetic_v<Type>, "Scan requires an arithmetic type");
+    assert(values.GetSize() == heads.GetSize());
+    const size_t size = values.GetSize();
+    Type* data = values.begin();
+    const bool* head_data = heads.begin();
+    const size_t part_count = std::min(thread_count, size / scan_detail::kMinParallelChunk);
+    if (part_count <= 1) {
+        scan_detail::SegmentedScanRange(data, head_data, size, Type{});
+        return;
+    }
+
+    SimpleVector<scan_detail::SegmentCarry<Type>> carries(part_count);
+    ParallelFor(part_count, part_count, [&](size_t part) {
+        const auto [begin, end] = SplitRange(size, part_count, part);
+        carries[part] = scan_detail::SegmentedSumRange(data + begin, head_data + begin, end - begin);
+    });
+    Type carry{};
+    for (auto& part_carry : carries) {
+        const Type next = part_carry.sum + (part_carry.has_head ? Type{} : carry);
+        part_carry.sum = carry;
+        carry = next;
+    }
+    ParallelFor(part_count, part_count, [&](size_t part) {
+        const auto [begin, end] = SplitRange(size, part_count, part);
+        scan_detail::SegmentedScanRange(data + begin, head_data + begin, end - begin, carries[part].sum);
+    });
+}
+
+template <typename Type>
+void SegmentedInclusiveScan(SimpleVector<Type>& values, const SimpleVector<bool>& heads, size_t thread_count = 1) {
+    SegmentedInclusiveScan(MutableSimpleVectorView<Type>(values), SimpleVectorView<bool>(heads), thread_count);
+}
@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "hash_utils.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+// Двоичный формат вектора: заголовок VectorFileHeader (64 байта), нули до
+// выравнивания данных и сами элементы в порядке байтов машины-писателя.
+// Поддерживаются только тривиально копируемые типы.
+struct VectorFileHeader {
+    char magic[8];
+    uint32_t version;
+    // kEndiannessMark в порядке байтов писателя.
+    uint32_t endianness;
+    uint32_t type_tag;
+    uint32_t element_size;
+    uint64_t count;
+    // Смещение данных от начала заголовка.
+    uint64_t data_offset;
+    uint64_t checksum;
+    uint8_t reserved[16];
+};
+
+static_assert(sizeof(VectorFileHeader) == 64, "VectorFileHeader must stay 64 bytes");
+
+// Метка типа элемента: вид (знаковое, беззнаковое, с плавающей точкой) и
+// размер. Для своих типов специализация задаёт собственную метку; 0 —
+// «произвольные байты», проверяется только размер элемента.
+template <typename Type>
+struct VectorTypeTag {
+    static constexpr uint32_t value = std::is_floating_point_v<Type>   ? 0x100u | sizeof(Type)
+                                      : std::is_same_v<Type, bool>     ? 0x400u
+                                      : std::is_signed_v<Type>         ? 0x200u | sizeof(Type)
+                                      : std::is_integral_v<Type>       ? 0x300u | sizeof(Type)
+                                                                       : 0u;
+};
+
+namespace serialization_detail {
+
+constexpr char kMagic[8] = {'S', 'V', 'E', 'C', 'T', 'O', 'R', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kEndiannessMark = 0x01020304u;
+constexpr size_t kDataAlignment = 64;
+
+constexpr uint64_t kPrime1 = 0x9e3779b185ebca87ULL;
+constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4fULL;
+
+inline uint64_t RotateLeft(uint64_t value, unsigned shift) noexcept {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+inline uint64_t ChecksumRound(uint64_t accumulator, uint64_t word) noexcept {
+    return RotateLeft(accumulator + word * kPrime2, 31) * kPrime1;
+}
+
+inline uint64_t LoadWord(const unsigned char* bytes) noexcept {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+// Контрольная сумма в духе xxHash: четыре независимые полосы по 8 байт дают
+// несколько байт за такт, поэтому проверка не ограничивает скорость чтения.
+inline uint64_t Checksum(const void* data, size_t size) noexcept {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            lanes[lane] = ChecksumRound(lanes[lane], LoadWord(bytes + offset + lane * 8));
+        }
+    }
+    uint64_t hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) +
+                    RotateLeft(lanes[3], 18) + size;
+    for (; offset + 8 <= size; offset += 8) {
+        hash = RotateLeft(hash ^ ChecksumRound(0, LoadWord(bytes + offset)), 27) * kPrime1;
+    }
+    for (; offset < size; ++offset) {
+        hash = RotateLeft(hash ^ (bytes[offset] * kPrime2), 11) * kPrime1;
+    }
+    return MixHash(hash);
+}
+
+inline size_t AlignUp(size_t value, size_t alignment) noexcept {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+[[noreturn]] inline void ThrowErrno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Дописывает все буферы, повторяя writev после частичной записи.
+inline void WriteAll(int fd, iovec* buffers, int count) {
+    while (count > 0) {
+        const ssize_t written = ::writev(fd, buffers, std::min(count, IOV_MAX));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("writev");
+        }
+        size_t left = static_cast<size_t>(written);
+        while (count > 0 && left >= buffers->iov_len) {
+            left -= buffers->iov_len;
+            ++buffers;
+            --count;
+        }
+        if (count > 0) {
+            buffers->iov_base = static_cast<char*>(buffers->iov_base) + left;
+            buffers->iov_len -= left;
+        }
+    }
+}
+
+inline void ReadAll(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t done = ::read(fd, bytes, size);
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowErrno("read");
+        }
+        if (done == 0) {
+            using namespace std::string_literals;
+            throw std::runtime_error("Unexpected end of vector file"s);
+        }
+        bytes += done;
+        size -= static_cast<size_t>(done);
+    }
+}
+
+template <typename Type>
+size_t DataOffset() noexcept {
+    return AlignUp(sizeof(VectorFileHeader), std::max(kDataAlignment, alignof(Type)));
+}
+
+template <typename Type>
+VectorFileHeader MakeHeader(SimpleVectorView<Type> values) noexcept {
+    VectorFileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.endianness = kEndiannessMark;
+    header.type_tag = VectorTypeTag<Type>::value;
+    header.element_size = sizeof(Type);
+    header.count = values.GetSize();
+    header.data_offset = DataOffset<Type>();
+    header.checksum = Checksum(values.GetData(), values.GetSize() * sizeof(Type));
+    return header;
+}
+
+template <typename Type>
+void ValidateHeader(const VectorFileHeader& header) {
+    using namespace std::string_literals;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a vector file"s);
+    }
+    if (header.version != kVersion) {
+        throw std::runtime_error("Unsupported vector file version "s + std::to_string(header.version));
+    }
+    if (header.endianness != kEndiannessMark) {
+        throw std::runtime_error("Vector file has foreign byte order"s);
+    }
+    if (header.element_size != sizeof(Type) || header.type_tag != VectorTypeTag<Type>::value) {
+        throw std::runtime_error("Vector file element type mismatch"s);
+    }
+    if (header.data_offset < sizeof(VectorFileHeader) || header.data_offset % alignof(Type) != 0 ||
+        header.data_offset > DataOffset<Type>() + kDataAlignment ||
+        header.count > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+        throw std::runtime_error("Corrupted vector file header"s);
+    }
+}
+
+// Сверяет размер, заявленный заголовком (начинающимся со смещения
+// header_offset), с длиной файла, чтобы испорченный count не приводил к
+// огромному выделению памяти. Возвращает false, если fd — не обычный файл
+// и длина неизвестна.
+inline bool CheckFileSize(int fd, const VectorFileHeader& header, uint64_t header_offset) {
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        ThrowErrno("fstat");
+    }
+    if (!S_ISREG(status.st_mode)) {
+        return false;
+    }
+    const auto file_size = static_cast<uint64_t>(status.st_size);
+    if (header_offset > file_size || header.data_offset > file_size - header_offset ||
+        header.count > (file_size - header_offset - header.data_offset) / header.element_size) {
+        using namespace std::string_literals;
+        throw std::runtime_error("Vector file is truncated"s);
+    }
+    return true;
+}
+
+// Читает count элементов в буфер без предварительного обнуления. Если
+// размер не сверен с файлом, буфер растёт по мере чтения.
+template <typename Type>
+SimpleVector<Type> ReadValues(int fd, size_t count, bool size_checked) {
+    constexpr size_t kReadStep = (size_t{1} << 20) / sizeof(Type) + 1;
+    size_t capacity = size_checked ? count : std::min(count, kReadStep);
+    std::unique_ptr<Type[]> data(new Type[capacity]);
+    for (size_t done = 0; done < count;) {
+        if (done == capacity) {
+            capacity = std::min(count, capacity * 2);
+            std::unique_ptr<Type[]> grown(new Type[capacity]);
+            std::memcpy(grown.get(), data.get(), done * sizeof(Type));
+            data = std::move(grown);
+        }
+        ReadAll(fd, data.get() + done, (capacity - done) * sizeof(Type));
+        done = capacity;
+    }
+    return SimpleVector<Type>::Adopt(data.release(), count, capacity);
+}
+
+inline void VerifyChecksum(const VectorFileHeader& header, const void* data) {
+    if (Checksum(data, header.count * header.element_size) != header.checksum) {
+        using namespace std::string_literals;
+        throw std::runtime_error("Vector file checksum mismatch"s);
+    }
+}
+
+}  // namespace serialization_detail
+
+// Записывает вектор с текущей позиции fd одним вызовом writev (повторы —
+// только при частичной записи). Ошибки ввода-вывода — std::system_error.
+template <typename Type>
+void WriteTo(int fd, SimpleVectorView<Type> values) {
+    static_assert(std::is_trivially_copyable_v<Type>, "WriteTo requires a trivially copyable type");
+    VectorFileHeader header = serialization_detail::MakeHeader(values);
+    static const char padding[serialization_detail::kDataAlignment + alignof(Type)] = {};
+    iovec buffers[3] = {
+        {&header, sizeof(header)},
+        {const_cast<char*>(padding), header.data_offset - sizeof(header)},
+        {const_cast<Type*>(values.GetData()), values.GetSize() * sizeof(Type)},
+    };
+    serialization_detail::WriteAll(fd, buffers, 3);
+}
+
+template <typename Type>
+void WriteTo(int fd, const SimpleVector<Type>& values) {
+    WriteTo(fd, SimpleVectorView<Type>(values));
+}
+
+// Читает вектор с текущей позиции fd: данные попадают в буфер вектора одним
+// read, поэтому несколько векторов можно писать и читать подряд. Для
+// обычного файла заявленный размер сверяется с длиной файла до выделения
+// памяти.
+template <typename Type>
+SimpleVector<Type> ReadFrom(int fd, bool verify_checksum = true) {
+    static_assert(std::is_trivially_copyable_v<Type>, "ReadFrom requires a trivially copyable type");
+    VectorFileHeader header;
+    serialization_detail::ReadAll(fd, &header, sizeof(header));
+    serialization_detail::ValidateHeader<Type>(header);
+    const off_t position = ::lseek(fd, 0, SEEK_CUR);
+    const bool size_checked =
+        position >= 0 && serialization_detail::CheckFileSize(fd, header, position - sizeof(header));
+    char padding[serialization_detail::kDataAlignment];
+    for (size_t left = header.data_offset - sizeof(header); left > 0;) {
+        const size_t step = std::min(left, sizeof(padding));
+        serialization_detail::ReadAll(fd, padding, step);
+        left -= step;
+    }
+    SimpleVector<Type> values = serialization_detail::ReadValues<Type>(fd, header.count, size_checked);
+    if (verify_checksum) {
+        serialization_detail::VerifyChecksum(header, values.begin());
+    }
+    return values;
+}
+
+// Отображённый в память файл вектора: элементы доступны через
+// SimpleVectorView без копирования, страницы подгружаются по требованию.
+// Проверка контрольной суммы читает весь файл, поэтому по умолчанию
+// выключена.
+template <typename Type>
+class MappedVector {
+public:
+    MappedVector() noexcept = default;
+
+    explicit MappedVector(const std::string& path, bool verify_checksum = false) {
+        static_assert(std::is_trivially_copyable_v<Type>, "MappedVector requires a trivially copyable type");
+        using namespace std::string_literals;
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            serialization_detail::ThrowErrno("open");
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "fstat");
+        }
+        mapping_size_ = static_cast<size_t>(status.st_size);
+        if (mapping_size_ < sizeof(VectorFileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Vector file is too short"s);
+        }
+        mapping_ = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (mapping_ == MAP_FAILED) {
+            mapping_ = nullptr;
+            throw std::system_error(error, std::generic_category(), "mmap");
+        }
+        try {
+            const auto& header = *static_cast<const VectorFileHeader*>(mapping_);
+            serialization_detail::ValidateHeader<Type>(header);
+            if (header.data_offset > mapping_size_ ||
+                header.count > (mapping_size_ - header.data_offset) / sizeof(Type)) {
+                throw std::runtime_error("Vector file is truncated"s);
+            }
+            const auto* data = reinterpret_cast<const Type*>(static_cast<const char*>(mapping_) + header.data_offset);
+            if (verify_checksum) {
+                serialization_detail::VerifyChecksum(header, data);
+            }
+            view_ = SimpleVectorView<Type>(data, header.count);
+        }
+        catch (...) {
+            Unmap();
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : mapping_(std::exchange(other.mapping_, nullptr)),
+          mapping_size_(std::exchange(other.mapping_size_, 0)),
+          view_(std::exchange(other.view_, {})) {
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Unmap();
+            mapping_ = std::exchange(rhs.mapping_, nullptr);
+            mapping_size_ = std::exchange(rhs.mapping_size_, 0);
+            view_ = std::exchange(rhs.view_, {});
+        }
+        return *this;
+    }
+
+    ~MappedVector() {
+        Unmap();
+    }
+
+    SimpleVectorView<Type> GetView() const noexcept {
+        return view_;
+    }
+
+    size_t GetSize() const noexcept {
+        return view_.GetSize();
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        return view_[index];
+    }
+
+private:
+    void Unmap() noexcept {
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, mapping_size_);
+        }
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+        view_ = {};
+    }
+
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    SimpleVectorView<Type> view_;
+};
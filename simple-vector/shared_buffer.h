@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <utility>
+
+#include "simple_vector.h"
+
+// Разделяемый SimpleVector с атомарным счётчиком ссылок. Копирование —
+// только увеличение счётчика; последний владелец освобождает вектор.
+// Менять содержимое можно лишь единственному владельцу (IsUnique).
+template <typename Type>
+class SharedBuffer {
+    struct Block {
+        std::atomic<size_t> ref_count{1};
+        SimpleVector<Type> items;
+    };
+
+public:
+    SharedBuffer() noexcept = default;
+
+    explicit SharedBuffer(SimpleVector<Type>&& items) : block_(new Block) {
+        block_->items = std::move(items);
+    }
+
+    SharedBuffer(const SharedBuffer& other) noexcept : block_(other.block_) {
+        if (block_ != nullptr) {
+            block_->ref_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedBuffer(SharedBuffer&& other) noexcept : block_(std::exchange(other.block_, nullptr)) {
+    }
+
+    SharedBuffer& operator=(const SharedBuffer& rhs) noexcept {
+        if (this != &rhs) {
+            SharedBuffer copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    SharedBuffer& operator=(SharedBuffer&& rhs) noexcept {
+        if (this != &rhs) {
+            Reset();
+            swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SharedBuffer() {
+        Reset();
+    }
+
+    explicit operator bool() const noexcept {
+        return block_ != nullptr;
+    }
+
+    size_t UseCount() const noexcept {
+        return block_ == nullptr ? 0 : block_->ref_count.load(std::memory_order_relaxed);
+    }
+
+    // acquire синхронизируется с release в Reset других владельцев: их
+    // чтения завершены до того, как единственный владелец начнёт запись.
+    bool IsUnique() const noexcept {
+        return block_ != nullptr && block_->ref_count.load(std::memory_order_acquire) == 1;
+    }
+
+    const SimpleVector<Type>& Get() const noexcept {
+        assert(block_ != nullptr);
+        return block_->items;
+    }
+
+    SimpleVector<Type>& GetMutable() noexcept {
+        assert(IsUnique());
+        return block_->items;
+    }
+
+    void Reset() noexcept {
+        if (block_ != nullptr && block_->ref_count.fetch_sub(1, std::memory_order_release) == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            delete block_;
+        }
+        block_ = nullptr;
+    }
+
+    void swap(SharedBuffer& other) noexcept {
+        std::swap(block_, other.block_);
+    }
+
+private:
+    Block* block_ = nullptr;
+};
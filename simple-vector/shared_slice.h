@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "cow_vector.h"
+#include "shared_buffer.h"
+#include "simple_vector.h"
+
+// Неизменяемый участок [offset, offset + size) разделяемого буфера.
+// Подсрезы создаются за O(1) без копирования и держат буфер живым, пока
+// жив хотя бы один из них.
+template <typename Type>
+class SharedSlice {
+public:
+    using ConstIterator = const Type*;
+
+    SharedSlice() noexcept = default;
+
+    explicit SharedSlice(SimpleVector<Type>&& items) : size_(items.GetSize()), buffer_(std::move(items)) {
+    }
+
+    // Срез разделяет буфер с вектором; последующая запись в вектор
+    // отделит его копию, и срез её не увидит.
+    explicit SharedSlice(const CowVector<Type>& items) : size_(items.GetSize()), buffer_(items.GetBuffer()) {
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    const Type* GetData() const noexcept {
+        return buffer_ ? buffer_.Get().begin() + offset_ : nullptr;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return GetData()[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+        return GetData()[index];
+    }
+
+    SharedSlice Subslice(size_t begin, size_t end) const {
+        assert(begin <= end && end <= size_);
+        SharedSlice result(*this);
+        result.offset_ += begin;
+        result.size_ = end - begin;
+        return result;
+    }
+
+    // Делит срез на куски по chunk_size элементов (последний может быть
+    // короче); все куски разделяют один буфер.
+    SimpleVector<SharedSlice> Split(size_t chunk_size) const {
+        assert(chunk_size > 0);
+        SimpleVector<SharedSlice> chunks;
+        chunks.Reserve((size_ + chunk_size - 1) / chunk_size);
+        for (size_t begin = 0; begin < size_; begin += chunk_size) {
+            chunks.PushBack(Subslice(begin, std::min(size_, begin + chunk_size)));
+        }
+        return chunks;
+    }
+
+    SimpleVector<Type> ToSimpleVector() const {
+        SimpleVector<Type> result;
+        result.Reserve(size_);
+        for (const Type& item : *this) {
+            result.PushBack(item);
+        }
+        return result;
+    }
+
+    // Превращает срез в собственный вектор. Если это единственная ссылка на
+    // буфер и срез покрывает его целиком, буфер забирается без копирования.
+    SimpleVector<Type> Detach() && {
+        SimpleVector<Type> result;
+        if (offset_ == 0 && buffer_.IsUnique() && buffer_.Get().GetSize() == size_) {
+            result = std::move(buffer_.GetMutable());
+        }
+        else {
+            result = ToSimpleVector();
+        }
+        buffer_.Reset();
+        offset_ = 0;
+        size_ = 0;
+        return result;
+    }
+
+    // Число срезов и векторов, разделяющих буфер.
+    size_t UseCount() const noexcept {
+        return buffer_.UseCount();
+    }
+
+    ConstIterator begin() const noexcept {
+        return GetData();
+    }
+
+    ConstIterator end() const noexcept {
+        return GetData() + size_;
+    }
+
+private:
+    size_t offset_ = 0;
+    size_t size_ = 0;
+    SharedBuffer<Type> buffer_;
+};
+
+template <typename Type>
+inline bool operator==(const SharedSlice<Type>& lhs, const SharedSlice<Type>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator!=(const SharedSlice<Type>& lhs, const SharedSlice<Type>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type>
+inline bool operator<(const SharedSlice<Type>& lhs, const SharedSlice<Type>& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator<=(const SharedSlice<Type>& lhs, const SharedSlice<Type>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type>
+inline bool operator>(const SharedSlice<Type>& lhs, const SharedSlice<Type>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type>
+inline bool operator>=(const SharedSlice<Type>& lhs, const SharedSlice<Type>& rhs) {
+    return !(lhs < rhs);
+}
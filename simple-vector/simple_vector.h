@@ -7,6 +7,7 @@
 #include <utility>
 #include <algorithm>
 #include <iterator>
+#include <memory>
 
 #include "array_ptr.h"
 
@@ -29,6 +30,14 @@ public:
     using Iterator = Type*;
     using ConstIterator = const Type*;
 
+    // Буфер, отданный ReleaseBuffer: все capacity элементов сконструированы,
+    // используются первые size.
+    struct Buffer {
+        std::unique_ptr<Type[], ArrayDeleter<Type>> data;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
     SimpleVector() noexcept = default;
 
     explicit SimpleVector(size_t size) : SimpleVector(size, Type{}) {
@@ -80,6 +89,33 @@ public:
         return *this;
     }
 
+    // Принимает владение готовым буфером без копирования. Все capacity
+    // элементов должны быть сконструированы; буфер освобождается deleter,
+    // в том числе при перевыделении.
+    static SimpleVector Adopt(Type* data, size_t size, size_t capacity, ArrayDeleter<Type> deleter = {}) noexcept {
+        assert(size <= capacity && (data != nullptr || capacity == 0));
+        SimpleVector result;
+        result.items_ = ArrayPtr<Type>(data, deleter);
+        result.size_ = size;
+        result.capacity_ = capacity;
+        return result;
+    }
+
+    static SimpleVector Adopt(Buffer&& buffer) noexcept {
+        const ArrayDeleter<Type> deleter = buffer.data.get_deleter();
+        return Adopt(buffer.data.release(), buffer.size, buffer.capacity, deleter);
+    }
+
+    // Отдаёт буфер вместе с его способом освобождения; вектор становится пустым.
+    [[nodiscard]] Buffer ReleaseBuffer() noexcept {
+        const ArrayDeleter<Type> deleter = items_.GetDeleter();
+        Buffer buffer{std::unique_ptr<Type[], ArrayDeleter<Type>>(items_.Release(), deleter), size_, capacity_};
+        items_ = ArrayPtr<Type>();
+        size_ = 0;
+        capacity_ = 0;
+        return buffer;
+    }
+
     size_t GetSize() const noexcept {
         return size_;
     }
@@ -233,6 +269,47 @@ public:
         return &items_[index];
     }
 
+    // Удаление за O(1): на место pos переносится последний элемент,
+    // порядок элементов не сохраняется.
+    Iterator UnorderedErase(ConstIterator pos) {
+        assert(!IsEmpty());
+        assert(pos >= items_.Get() && pos < (items_.Get() + size_));
+        Iterator new_pos = const_cast<Iterator>(pos);
+        Iterator last = items_.Get() + (size_ - 1);
+        if (new_pos != last) {
+            *new_pos = std::move(*last);
+        }
+        --size_;
+        return new_pos;
+    }
+
+    template <typename Predicate>
+    size_t EraseIf(Predicate predicate) {
+        Iterator new_end = std::remove_if(begin(), end(), predicate);
+        const size_t erased = static_cast<size_t>(std::distance(new_end, end()));
+        size_ -= erased;
+        return erased;
+    }
+
+    // Удаляет элементы по строго возрастающим индексам за один проход.
+    size_t EraseIndices(const SimpleVector<size_t>& sorted_indices) {
+        if (sorted_indices.IsEmpty()) {
+            return 0;
+        }
+        assert(sorted_indices[sorted_indices.GetSize() - 1] < size_);
+        size_t write = sorted_indices[0];
+        for (size_t i = 0; i < sorted_indices.GetSize(); ++i) {
+            assert(i == 0 || sorted_indices[i - 1] < sorted_indices[i]);
+            const size_t keep_from = sorted_indices[i] + 1;
+            const size_t keep_to = (i + 1 < sorted_indices.GetSize() ? sorted_indices[i + 1] : size_);
+            std::move(items_.Get() + keep_from, items_.Get() + keep_to, items_.Get() + write);
+            write += keep_to - keep_from;
+        }
+        const size_t erased = size_ - write;
+        size_ = write;
+        return erased;
+    }
+
     void swap(SimpleVector& other) noexcept {
         items_.swap(other.items_);
         std::swap(size_, other.size_);
@@ -0,0 +1,363 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+#include "array_ptr.h"
+#include "simple_vector.h"
+
+// Невладеющее представление непрерывного участка элементов: тот же
+// интерфейс чтения и сравнения, что у SimpleVector, но без копирования
+// данных. Подходит для буферов из mmap, сети или чужих библиотек; владелец
+// буфера должен пережить представление.
+template <typename Type>
+class SimpleVectorView {
+public:
+    using ConstIterator = const Type*;
+
+    SimpleVectorView() noexcept = default;
+
+    SimpleVectorView(const Type* data, size_t size) noexcept : data_(data), size_(size) {
+        assert(data != nullptr || size == 0);
+    }
+
+    SimpleVectorView(const SimpleVector<Type>& items) noexcept : data_(items.begin()), size_(items.GetSize()) {
+    }
+
+    // Представление временного вектора повисло бы сразу после выражения.
+    SimpleVectorView(SimpleVector<Type>&&) = delete;
+
+    SimpleVectorView(const ArrayPtr<Type>& items, size_t size) noexcept : SimpleVectorView(items.Get(), size) {
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    const Type* GetData() const noexcept {
+        return data_;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+        return data_[index];
+    }
+
+    SimpleVectorView Subview(size_t begin, size_t end) const noexcept {
+        assert(begin <= end && end <= size_);
+        return SimpleVectorView(data_ + begin, end - begin);
+    }
+
+    SimpleVector<Type> ToSimpleVector() const {
+        SimpleVector<Type> result(size_);
+        std::copy(begin(), end(), result.begin());
+        return result;
+    }
+
+    ConstIterator begin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+    // Сравнения находятся поиском по аргументам и принимают любой операнд,
+    // приводимый к представлению. Для SimpleVector, в том числе временного,
+    // есть отдельные перегрузки: он не приводится к представлению неявно.
+    friend bool operator==(SimpleVectorView lhs, SimpleVectorView rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    friend bool operator!=(SimpleVectorView lhs, SimpleVectorView rhs) {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator<(SimpleVectorView lhs, SimpleVectorView rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    friend bool operator<=(SimpleVectorView lhs, SimpleVectorView rhs) {
+        return !(rhs < lhs);
+    }
+
+    friend bool operator>(SimpleVectorView lhs, SimpleVectorView rhs) {
+        return rhs < lhs;
+    }
+
+    friend bool operator>=(SimpleVectorView lhs, SimpleVectorView rhs) {
+        return !(lhs < rhs);
+    }
+
+    friend bool operator==(SimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return lhs == SimpleVectorView(rhs);
+    }
+
+    friend bool operator==(const SimpleVector<Type>& lhs, SimpleVectorView rhs) {
+        return SimpleVectorView(lhs) == rhs;
+    }
+
+    friend bool operator!=(SimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return lhs != SimpleVectorView(rhs);
+    }
+
+    friend bool operator!=(const SimpleVector<Type>& lhs, SimpleVectorView rhs) {
+        return SimpleVectorView(lhs) != rhs;
+    }
+
+    friend bool operator<(SimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return lhs < SimpleVectorView(rhs);
+    }
+
+    friend bool operator<(const SimpleVector<Type>& lhs, SimpleVectorView rhs) {
+        return SimpleVectorView(lhs) < rhs;
+    }
+
+    friend bool operator<=(SimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return lhs <= SimpleVectorView(rhs);
+    }
+
+    friend bool operator<=(const SimpleVector<Type>& lhs, SimpleVectorView rhs) {
+        return SimpleVectorView(lhs) <= rhs;
+    }
+
+    friend bool operator>(SimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return lhs > SimpleVectorView(rhs);
+    }
+
+    friend bool operator>(const SimpleVector<Type>& lhs, SimpleVectorView rhs) {
+        return SimpleVectorView(lhs) > rhs;
+    }
+
+    friend bool operator>=(SimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return lhs >= SimpleVectorView(rhs);
+    }
+
+    friend bool operator>=(const SimpleVector<Type>& lhs, SimpleVectorView rhs) {
+        return SimpleVectorView(lhs) >= rhs;
+    }
+
+private:
+    const Type* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Представление с правом записи в элементы; размер не меняется.
+template <typename Type>
+class MutableSimpleVectorView {
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    MutableSimpleVectorView() noexcept = default;
+
+    MutableSimpleVectorView(Type* data, size_t size) noexcept : data_(data), size_(size) {
+        assert(data != nullptr || size == 0);
+    }
+
+    MutableSimpleVectorView(SimpleVector<Type>& items) noexcept : data_(items.begin()), size_(items.GetSize()) {
+    }
+
+    MutableSimpleVectorView(ArrayPtr<Type>& items, size_t size) noexcept : MutableSimpleVectorView(items.Get(), size) {
+    }
+
+    operator SimpleVectorView<Type>() const noexcept {
+        return SimpleVectorView<Type>(data_, size_);
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    Type* GetData() const noexcept {
+        return data_;
+    }
+
+    Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    Type& At(size_t index) const {
+        if (index >= size_) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+        return data_[index];
+    }
+
+    MutableSimpleVectorView Subview(size_t begin, size_t end) const noexcept {
+        assert(begin <= end && end <= size_);
+        return MutableSimpleVectorView(data_ + begin, end - begin);
+    }
+
+    SimpleVector<Type> ToSimpleVector() const {
+        return SimpleVectorView<Type>(*this).ToSimpleVector();
+    }
+
+    Iterator begin() const noexcept {
+        return data_;
+    }
+
+    Iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+    friend bool operator==(MutableSimpleVectorView lhs, SimpleVectorView<Type> rhs) {
+        return SimpleVectorView<Type>(lhs) == rhs;
+    }
+
+    friend bool operator!=(MutableSimpleVectorView lhs, SimpleVectorView<Type> rhs) {
+        return SimpleVectorView<Type>(lhs) != rhs;
+    }
+
+    friend bool operator<(MutableSimpleVectorView lhs, SimpleVectorView<Type> rhs) {
+        return SimpleVectorView<Type>(lhs) < rhs;
+    }
+
+    friend bool operator<=(MutableSimpleVectorView lhs, SimpleVectorView<Type> rhs) {
+        return SimpleVectorView<Type>(lhs) <= rhs;
+    }
+
+    friend bool operator>(MutableSimpleVectorView lhs, SimpleVectorView<Type> rhs) {
+        return SimpleVectorView<Type>(lhs) > rhs;
+    }
+
+    friend bool operator>=(MutableSimpleVectorView lhs, SimpleVectorView<Type> rhs) {
+        return SimpleVectorView<Type>(lhs) >= rhs;
+    }
+
+    friend bool operator==(MutableSimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return SimpleVectorView<Type>(lhs) == SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator!=(MutableSimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return SimpleVectorView<Type>(lhs) != SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator<(MutableSimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return SimpleVectorView<Type>(lhs) < SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator<=(MutableSimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return SimpleVectorView<Type>(lhs) <= SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator>(MutableSimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return SimpleVectorView<Type>(lhs) > SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator>=(MutableSimpleVectorView lhs, const SimpleVector<Type>& rhs) {
+        return SimpleVectorView<Type>(lhs) >= SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator==(MutableSimpleVectorView lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) == SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator!=(MutableSimpleVectorView lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) != SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator<(MutableSimpleVectorView lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) < SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator<=(MutableSimpleVectorView lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) <= SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator>(MutableSimpleVectorView lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) > SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator>=(MutableSimpleVectorView lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) >= SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator==(SimpleVectorView<Type> lhs, MutableSimpleVectorView rhs) {
+        return lhs == SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator!=(SimpleVectorView<Type> lhs, MutableSimpleVectorView rhs) {
+        return lhs != SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator<(SimpleVectorView<Type> lhs, MutableSimpleVectorView rhs) {
+        return lhs < SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator<=(SimpleVectorView<Type> lhs, MutableSimpleVectorView rhs) {
+        return lhs <= SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator>(SimpleVectorView<Type> lhs, MutableSimpleVectorView rhs) {
+        return lhs > SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator>=(SimpleVectorView<Type> lhs, MutableSimpleVectorView rhs) {
+        return lhs >= SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator==(const SimpleVector<Type>& lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) == SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator!=(const SimpleVector<Type>& lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) != SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator<(const SimpleVector<Type>& lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) < SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator<=(const SimpleVector<Type>& lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) <= SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator>(const SimpleVector<Type>& lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) > SimpleVectorView<Type>(rhs);
+    }
+
+    friend bool operator>=(const SimpleVector<Type>& lhs, MutableSimpleVectorView rhs) {
+        return SimpleVectorView<Type>(lhs) >= SimpleVectorView<Type>(rhs);
+    }
+
+private:
+    Type* data_ = nullptr;
+    size_t size_ = 0;
+};
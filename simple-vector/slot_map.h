@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "simple_vector.h"
+
+struct SlotHandle {
+    uint32_t index = std::numeric_limits<uint32_t>::max();
+    uint32_t generation = 0;
+};
+
+inline bool operator==(SlotHandle lhs, SlotHandle rhs) {
+    return lhs.index == rhs.index && lhs.generation == rhs.generation;
+}
+
+inline bool operator!=(SlotHandle lhs, SlotHandle rhs) {
+    return !(lhs == rhs);
+}
+
+// Значения лежат плотно в SimpleVector, поэтому обход — линейный проход.
+// Удаление переносит последний элемент на место удалённого, а внешние ссылки
+// идут через слоты с поколениями: после удаления старый дескриптор перестаёт
+// быть действительным, даже если слот занят заново.
+template <typename Type>
+class SlotMap {
+public:
+    using Iterator = typename SimpleVector<Type>::Iterator;
+    using ConstIterator = typename SimpleVector<Type>::ConstIterator;
+
+    SlotMap() noexcept = default;
+
+    size_t GetSize() const noexcept {
+        return values_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return values_.IsEmpty();
+    }
+
+    void Reserve(size_t new_capacity) {
+        values_.Reserve(new_capacity);
+        value_slots_.Reserve(new_capacity);
+        slots_.Reserve(new_capacity);
+    }
+
+    SlotHandle Insert(const Type& value) {
+        values_.PushBack(value);
+        return BindLastValue();
+    }
+
+    SlotHandle Insert(Type&& value) {
+        values_.PushBack(std::move(value));
+        return BindLastValue();
+    }
+
+    bool Contains(SlotHandle handle) const noexcept {
+        return handle.index < slots_.GetSize() && slots_[handle.index].generation == handle.generation
+            && IsOccupied(slots_[handle.index]);
+    }
+
+    Type* Find(SlotHandle handle) noexcept {
+        return Contains(handle) ? &values_[slots_[handle.index].index] : nullptr;
+    }
+
+    const Type* Find(SlotHandle handle) const noexcept {
+        return Contains(handle) ? &values_[slots_[handle.index].index] : nullptr;
+    }
+
+    Type& operator[](SlotHandle handle) noexcept {
+        assert(Contains(handle));
+        return values_[slots_[handle.index].index];
+    }
+
+    const Type& operator[](SlotHandle handle) const noexcept {
+        assert(Contains(handle));
+        return values_[slots_[handle.index].index];
+    }
+
+    Type& At(SlotHandle handle) {
+        if (!Contains(handle)) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Invalid slot handle"s);
+        }
+        return values_[slots_[handle.index].index];
+    }
+
+    const Type& At(SlotHandle handle) const {
+        if (!Contains(handle)) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Invalid slot handle"s);
+        }
+        return values_[slots_[handle.index].index];
+    }
+
+    // Дескриптор элемента, лежащего в плотном массиве по индексу index.
+    SlotHandle GetHandle(size_t index) const noexcept {
+        assert(index < values_.GetSize());
+        const uint32_t slot = value_slots_[index];
+        return {slot, slots_[slot].generation};
+    }
+
+    bool Erase(SlotHandle handle) {
+        if (!Contains(handle)) {
+            return false;
+        }
+        Slot& slot = slots_[handle.index];
+        const uint32_t index = slot.index;
+        const uint32_t last = static_cast<uint32_t>(values_.GetSize() - 1);
+        if (index != last) {
+            values_[index] = std::move(values_[last]);
+            value_slots_[index] = value_slots_[last];
+            slots_[value_slots_[index]].index = index;
+        }
+        values_.PopBack();
+        value_slots_.PopBack();
+        ReleaseSlot(handle.index);
+        return true;
+    }
+
+    void Clear() noexcept {
+        for (uint32_t slot : value_slots_) {
+            ReleaseSlot(slot);
+        }
+        values_.Clear();
+        value_slots_.Clear();
+    }
+
+    Iterator begin() noexcept {
+        return values_.begin();
+    }
+
+    Iterator end() noexcept {
+        return values_.end();
+    }
+
+    ConstIterator begin() const noexcept {
+        return values_.begin();
+    }
+
+    ConstIterator end() const noexcept {
+        return values_.end();
+    }
+
+private:
+    static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+    // Нечётное поколение означает занятый слот. Для свободного слота index
+    // хранит следующий свободный слот.
+    struct Slot {
+        uint32_t index = kNoSlot;
+        uint32_t generation = 0;
+    };
+
+    static bool IsOccupied(const Slot& slot) noexcept {
+        return (slot.generation & 1u) != 0;
+    }
+
+    SlotHandle BindLastValue() {
+        const uint32_t index = static_cast<uint32_t>(values_.GetSize() - 1);
+        uint32_t slot = free_head_;
+        if (slot == kNoSlot) {
+            slot = static_cast<uint32_t>(slots_.GetSize());
+            slots_.PushBack(Slot{});
+        }
+        else {
+            free_head_ = slots_[slot].index;
+        }
+        value_slots_.PushBack(slot);
+        slots_[slot].index = index;
+        ++slots_[slot].generation;
+        return {slot, slots_[slot].generation};
+    }
+
+    void ReleaseSlot(uint32_t slot) noexcept {
+        ++slots_[slot].generation;
+        slots_[slot].index = free_head_;
+        free_head_ = slot;
+    }
+
+    SimpleVector<Type> values_;
+    SimpleVector<uint32_t> value_slots_;
+    SimpleVector<Slot> slots_;
+    uint32_t free_head_ = kNoSlot;
+};
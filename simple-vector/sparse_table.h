@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "parallel.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+namespace sparse_table_detail {
+
+constexpr size_t kMinRowsPerTask = size_t{1} << 15;
+
+inline unsigned FloorLog2(uint64_t value) noexcept {
+    assert(value != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+}
+
+}  // namespace sparse_table_detail
+
+// Разреженная таблица для неизменяемого вектора: ответ на запрос
+// минимума (по Compare) на отрезке [begin, end) за O(1) после построения за
+// O(n log n). Уровень k хранит индекс лучшего элемента каждого отрезка длины
+// 2^(k + 1); уровни строятся параллельно по кускам. Среди равных
+// выбирается самый левый. Данные (SimpleVector или представление) не
+// копируются: они должны пережить таблицу и не меняться, пока она
+// используется.
+template <typename Type, typename Compare = std::less<Type>>
+class SparseTable {
+public:
+    SparseTable() = default;
+
+    explicit SparseTable(SimpleVectorView<Type> values, size_t thread_count = 1, Compare compare = Compare{})
+        : values_(values), compare_(compare) {
+        const size_t size = values.GetSize();
+        assert(size <= std::numeric_limits<uint32_t>::max());
+        const unsigned level_count = size < 2 ? 0 : sparse_table_detail::FloorLog2(size);
+        levels_ = SimpleVector<SimpleVector<uint32_t>>(level_count);
+        for (unsigned level = 0; level < level_count; ++level) {
+            const size_t half = size_t{1} << level;
+            const size_t level_size = size - 2 * half + 1;
+            levels_[level] = SimpleVector<uint32_t>(level_size);
+            const size_t task_count = std::max<size_t>(1, std::min(thread_count, level_size / sparse_table_detail::kMinRowsPerTask));
+            ParallelFor(task_count, task_count, [&](size_t task) {
+                const auto [begin, end] = SplitRange(level_size, task_count, task);
+                for (size_t index = begin; index < end; ++index) {
+                    levels_[level][index] = static_cast<uint32_t>(Better(At(level, index), At(level, index + half)));
+                }
+            });
+        }
+    }
+
+    explicit SparseTable(const SimpleVector<Type>& values, size_t thread_count = 1, Compare compare = Compare{})
+        : SparseTable(SimpleVectorView<Type>(values), thread_count, compare) {
+    }
+
+    // Таблица ссылается на данные, и временный вектор повис бы сразу.
+    SparseTable(SimpleVector<Type>&&, size_t = 1, Compare = Compare{}) = delete;
+
+    size_t GetSize() const noexcept {
+        return values_.GetSize();
+    }
+
+    size_t QueryIndex(size_t begin, size_t end) const {
+        assert(begin < end && end <= GetSize());
+        const unsigned level = sparse_table_detail::FloorLog2(end - begin);
+        if (level == 0) {
+            return begin;
+        }
+        return Better(At(level, begin), At(level, end - (size_t{1} << level)));
+    }
+
+    const Type& Query(size_t begin, size_t end) const {
+        return values_[QueryIndex(begin, end)];
+    }
+
+private:
+    // Индекс лучшего элемента на отрезке длины 2^level, начинающемся в index.
+    size_t At(unsigned level, size_t index) const noexcept {
+        return level == 0 ? index : levels_[level - 1][index];
+    }
+
+    size_t Better(size_t lhs, size_t rhs) const {
+        const Type& left = values_[lhs];
+        const Type& right = values_[rhs];
+        if (compare_(right, left) || (!compare_(left, right) && rhs < lhs)) {
+            return rhs;
+        }
+        return lhs;
+    }
+
+    SimpleVectorView<Type> values_;
+    SimpleVector<SimpleVector<uint32_t>> levels_;
+    Compare compare_;
+};
+
+template <typename Type>
+using MinSparseTable = SparseTable<Type, std::less<Type>>;
+
+template <typename Type>
+using MaxSparseTable = SparseTable<Type, std::greater<Type>>;
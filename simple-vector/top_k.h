@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#include "heap_vector.h"
+#include "parallel.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+namespace top_k_detail {
+
+// Куча из k элементов выгодна, пока k мало по сравнению с n; дальше
+// быстрее nth_element по массиву индексов.
+constexpr size_t kHeapMaxRatio = 64;
+constexpr size_t kMinParallelRows = size_t{1} << 16;
+
+// Упорядочивает индексы по убыванию значения по Compare, при равенстве —
+// по возрастанию индекса, чтобы результат не зависел от стратегии.
+template <typename Type, typename Compare>
+struct IndexOrder {
+    bool operator()(size_t lhs, size_t rhs) const {
+        if (compare(values[rhs], values[lhs])) {
+            return true;
+        }
+        if (compare(values[lhs], values[rhs])) {
+            return false;
+        }
+        return lhs < rhs;
+    }
+
+    const Type* values;
+    Compare compare;
+};
+
+// Индексы k лучших элементов из [begin, end) через ограниченную кучу:
+// на вершине худший из отобранных.
+template <typename Type, typename Compare>
+SimpleVector<size_t> HeapSelect(const Type* values, size_t begin, size_t end, size_t k, Compare compare) {
+    const IndexOrder<Type, Compare> order{values, compare};
+    HeapVector<size_t, IndexOrder<Type, Compare>> heap(order);
+    heap.Reserve(k + 1);
+    for (size_t index = begin; index < end; ++index) {
+        if (heap.GetSize() < k) {
+            heap.Push(index);
+        }
+        else if (order(index, heap.Top())) {
+            heap.Pop();
+            heap.Push(index);
+        }
+    }
+    return heap.ReleaseItems();
+}
+
+template <typename Type, typename Compare>
+SimpleVector<size_t> SelectIndices(SimpleVectorView<Type> values, size_t k, Compare compare, size_t thread_count) {
+    const size_t size = values.GetSize();
+    k = std::min(k, size);
+    const IndexOrder<Type, Compare> order{values.begin(), compare};
+    SimpleVector<size_t> result;
+    if (k == 0) {
+        return result;
+    }
+
+    const size_t part_count = std::min(thread_count, size / kMinParallelRows);
+    if (k * kHeapMaxRatio <= size && part_count > 1) {
+        // Каждый поток отбирает k лучших в своём куске, затем кандидаты
+        // сливаются той же кучей.
+        SimpleVector<SimpleVector<size_t>> candidates(part_count);
+        ParallelFor(part_count, part_count, [&](size_t part) {
+            const auto [begin, end] = SplitRange(size, part_count, part);
+            candidates[part] = HeapSelect(values.begin(), begin, end, k, compare);
+        });
+        HeapVector<size_t, IndexOrder<Type, Compare>> heap(order);
+        heap.Reserve(k + 1);
+        for (const SimpleVector<size_t>& part : candidates) {
+            for (size_t index : part) {
+                if (heap.GetSize() < k) {
+                    heap.Push(index);
+                }
+                else if (order(index, heap.Top())) {
+                    heap.Pop();
+                    heap.Push(index);
+                }
+            }
+        }
+        result = heap.ReleaseItems();
+    }
+    else if (k * kHeapMaxRatio <= size) {
+        result = HeapSelect(values.begin(), 0, size, k, compare);
+    }
+    else {
+        result = SimpleVector<size_t>(size);
+        for (size_t index = 0; index < size; ++index) {
+            result[index] = index;
+        }
+        std::nth_element(result.begin(), result.begin() + (k - 1), result.end(), order);
+        result.Resize(k);
+    }
+    std::sort(result.begin(), result.end(), order);
+    return result;
+}
+
+template <typename Type>
+SimpleVector<Type> IndicesToValues(SimpleVectorView<Type> values, const SimpleVector<size_t>& indices) {
+    SimpleVector<Type> result(indices.GetSize());
+    for (size_t i = 0; i < indices.GetSize(); ++i) {
+        result[i] = values[indices[i]];
+    }
+    return result;
+}
+
+}  // namespace top_k_detail
+
+// Индексы k наибольших элементов по убыванию значения (равные — по
+// возрастанию индекса). Полная сортировка не выполняется: при k << n
+// используется ограниченная куча (при thread_count > 1 — своя в каждом
+// потоке с последующим слиянием), иначе nth_element.
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<size_t> TopKIndices(SimpleVectorView<Type> values, size_t k, size_t thread_count = 1,
+                                 Compare compare = Compare{}) {
+    return top_k_detail::SelectIndices(values, k, compare, thread_count);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<size_t> TopKIndices(const SimpleVector<Type>& values, size_t k, size_t thread_count = 1,
+                                 Compare compare = Compare{}) {
+    return TopKIndices(SimpleVectorView<Type>(values), k, thread_count, compare);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<size_t> TopKIndices(MutableSimpleVectorView<Type> values, size_t k, size_t thread_count = 1,
+                                 Compare compare = Compare{}) {
+    return TopKIndices(SimpleVectorView<Type>(values), k, thread_count, compare);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<Type> TopK(SimpleVectorView<Type> values, size_t k, size_t thread_count = 1,
+                        Compare compare = Compare{}) {
+    return top_k_detail::IndicesToValues(values, TopKIndices(values, k, thread_count, compare));
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<Type> TopK(const SimpleVector<Type>& values, size_t k, size_t thread_count = 1,
+                        Compare compare = Compare{}) {
+    return TopK(SimpleVectorView<Type>(values), k, thread_count, compare);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<Type> TopK(MutableSimpleVectorView<Type> values, size_t k, size_t thread_count = 1,
+                        Compare compare = Compare{}) {
+    return TopK(SimpleVectorView<Type>(values), k, thread_count, compare);
+}
+
+// Индексы k наименьших элементов по возрастанию значения.
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<size_t> BottomKIndices(SimpleVectorView<Type> values, size_t k, size_t thread_count = 1,
+                                    Compare compare = Compare{}) {
+    auto reversed = [compare](const Type& lhs, const Type& rhs) {
+        return compare(rhs, lhs);
+    };
+    return top_k_detail::SelectIndices(values, k, reversed, thread_count);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<size_t> BottomKIndices(const SimpleVector<Type>& values, size_t k, size_t thread_count = 1,
+                                    Compare compare = Compare{}) {
+    return BottomKIndices(SimpleVectorView<Type>(values), k, thread_count, compare);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<size_t> BottomKIndices(MutableSimpleVectorView<Type> values, size_t k, size_t thread_count = 1,
+                                    Compare compare = Compare{}) {
+    return BottomKIndices(SimpleVectorView<Type>(values), k, thread_count, compare);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<Type> BottomK(SimpleVectorView<Type> values, size_t k, size_t thread_count = 1,
+                           Compare compare = Compare{}) {
+    return top_k_detail::IndicesToValues(values, BottomKIndices(values, k, thread_count, compare));
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<Type> BottomK(const SimpleVector<Type>& values, size_t k, size_t thread_count = 1,
+                           Compare compare = Compare{}) {
+    return BottomK(SimpleVectorView<Type>(values), k, thread_count, compare);
+}
+
+template <typename Type, typename Compare = std::less<Type>>
+SimpleVector<Type> BottomK(MutableSimpleVectorView<Type> values, size_t k, size_t thread_count = 1,
+                           Compare compare = Compare{}) {
+    return BottomK(SimpleVectorView<Type>(values), k, thread_count, compare);
+}
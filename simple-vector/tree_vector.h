@@ -0,0 +1,643 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "parallel.h"
+#include "simple_vector.h"
+
+// Последовательность на счётном B+-дереве: внутренние узлы хранят размеры
+// поддеревьев, поэтому доступ по индексу, вставка и удаление в любой позиции
+// стоят O(log n). Элементы лежат в листах размером в несколько кэш-линий,
+// листы связаны в список, и последовательный обход идёт по ним без спуска по
+// дереву.
+template <typename Type>
+class TreeVector {
+    static constexpr size_t kLeafBytes = 256;
+    static constexpr size_t kLeafCapacity = std::max<size_t>(8, kLeafBytes / sizeof(Type));
+    static constexpr size_t kBranching = 32;
+
+    struct Node {
+    };
+
+    struct Leaf : Node {
+        Type items[kLeafCapacity]{};
+        size_t size = 0;
+        Leaf* prev = nullptr;
+        Leaf* next = nullptr;
+    };
+
+    struct Inner : Node {
+        Node* children[kBranching]{};
+        size_t counts[kBranching]{};
+        size_t size = 0;
+    };
+
+    template <bool IsConst>
+    class BasicIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const Type*, Type*>;
+        using reference = std::conditional_t<IsConst, const Type&, Type&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Leaf* leaf, size_t offset) noexcept : leaf_(leaf), offset_(offset) {
+        }
+
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) noexcept : leaf_(other.leaf_), offset_(other.offset_) {
+        }
+
+        reference operator*() const noexcept {
+            return leaf_->items[offset_];
+        }
+
+        pointer operator->() const noexcept {
+            return &leaf_->items[offset_];
+        }
+
+        BasicIterator& operator++() noexcept {
+            if (++offset_ == leaf_->size) {
+                leaf_ = leaf_->next;
+                offset_ = 0;
+            }
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const BasicIterator& other) const noexcept {
+            return leaf_ == other.leaf_ && offset_ == other.offset_;
+        }
+
+        bool operator!=(const BasicIterator& other) const noexcept {
+            return !(*this == other);
+        }
+
+    private:
+        friend class TreeVector;
+        friend class BasicIterator<!IsConst>;
+
+        Leaf* leaf_ = nullptr;
+        size_t offset_ = 0;
+    };
+
+public:
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    TreeVector() noexcept = default;
+
+    TreeVector(std::initializer_list<Type> init) {
+        BuildFrom(init.begin(), init.size());
+    }
+
+    explicit TreeVector(const SimpleVector<Type>& values) {
+        BuildFrom(values.begin(), values.GetSize());
+    }
+
+    TreeVector(const TreeVector& other) {
+        BuildFrom(other.begin(), other.size_);
+    }
+
+    TreeVector(TreeVector&& other) noexcept {
+        swap(other);
+    }
+
+    TreeVector& operator=(const TreeVector& rhs) {
+        if (this != &rhs) {
+            TreeVector copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    TreeVector& operator=(TreeVector&& rhs) noexcept {
+        if (this != &rhs) {
+            swap(rhs);
+        }
+        return *this;
+    }
+
+    ~TreeVector() {
+        Clear();
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        auto [leaf, offset] = Locate(index);
+        return leaf->items[offset];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        auto [leaf, offset] = Locate(index);
+        return leaf->items[offset];
+    }
+
+    Type& At(size_t index) {
+        if (index >= size_) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            using namespace std::string_literals;
+            throw std::out_of_range("Out of range"s);
+        }
+        return (*this)[index];
+    }
+
+    void Insert(size_t index, Type value) {
+        assert(index <= size_);
+        if (root_ == nullptr) {
+            Leaf* leaf = new Leaf;
+            root_ = leaf;
+            first_leaf_ = leaf;
+            last_leaf_ = leaf;
+            height_ = 0;
+        }
+        size_t right_count = 0;
+        Node* right = InsertInto(root_, height_, index, std::move(value), right_count);
+        ++size_;
+        if (right != nullptr) {
+            Inner* new_root = new Inner;
+            new_root->children[0] = root_;
+            new_root->counts[0] = size_ - right_count;
+            new_root->children[1] = right;
+            new_root->counts[1] = right_count;
+            new_root->size = 2;
+            root_ = new_root;
+            ++height_;
+        }
+    }
+
+    void PushBack(Type value) {
+        Insert(size_, std::move(value));
+    }
+
+    void Erase(size_t index) {
+        assert(index < size_);
+        EraseFrom(root_, height_, index);
+        --size_;
+        while (height_ > 0 && static_cast<Inner*>(root_)->size == 1) {
+            Inner* old_root = static_cast<Inner*>(root_);
+            root_ = old_root->children[0];
+            delete old_root;
+            --height_;
+        }
+        if (size_ == 0) {
+            Clear();
+        }
+    }
+
+    void PopBack() {
+        Erase(size_ - 1);
+    }
+
+    void Clear() noexcept {
+        if (root_ != nullptr) {
+            DeleteSubtree(root_, height_);
+        }
+        root_ = nullptr;
+        first_leaf_ = nullptr;
+        last_leaf_ = nullptr;
+        size_ = 0;
+        height_ = 0;
+    }
+
+    // Отрезает элементы [index, size) в новую последовательность. Элементы
+    // не копируются: делится не более одного листа, а индексные уровни обеих
+    // частей перестраиваются над списком листов за O(n / размер листа).
+    TreeVector Split(size_t index) {
+        assert(index <= size_);
+        TreeVector right;
+        if (index == size_) {
+            return right;
+        }
+        if (index == 0) {
+            swap(right);
+            return right;
+        }
+        auto [leaf, offset] = Locate(index);
+        if (offset > 0) {
+            Leaf* tail = new Leaf;
+            std::move(leaf->items + offset, leaf->items + leaf->size, tail->items);
+            tail->size = leaf->size - offset;
+            leaf->size = offset;
+            LinkAfter(leaf, tail);
+            leaf = tail;
+        }
+        SimpleVector<Leaf*> left_leaves = CollectLeaves(first_leaf_, leaf);
+        SimpleVector<Leaf*> right_leaves = CollectLeaves(leaf, nullptr);
+        DeleteInnerNodes(root_, height_);
+        leaf->prev->next = nullptr;
+        leaf->prev = nullptr;
+        right.AdoptLeaves(right_leaves, size_ - index);
+        AdoptLeaves(left_leaves, index);
+        return right;
+    }
+
+    // Приписывает other в конец, забирая его листы без копирования элементов.
+    void Concat(TreeVector&& other) {
+        if (other.IsEmpty()) {
+            return;
+        }
+        if (IsEmpty()) {
+            swap(other);
+            return;
+        }
+        SimpleVector<Leaf*> leaves = CollectLeaves(first_leaf_, nullptr);
+        for (Leaf* leaf : CollectLeaves(other.first_leaf_, nullptr)) {
+            leaves.PushBack(leaf);
+        }
+        last_leaf_->next = other.first_leaf_;
+        other.first_leaf_->prev = last_leaf_;
+        const size_t total = size_ + other.size_;
+        DeleteInnerNodes(root_, height_);
+        DeleteInnerNodes(other.root_, other.height_);
+        other.root_ = nullptr;
+        other.first_leaf_ = nullptr;
+        other.last_leaf_ = nullptr;
+        other.size_ = 0;
+        other.height_ = 0;
+        AdoptLeaves(leaves, total);
+    }
+
+    Iterator begin() noexcept {
+        return {first_leaf_, 0};
+    }
+
+    Iterator end() noexcept {
+        return {nullptr, 0};
+    }
+
+    ConstIterator begin() const noexcept {
+        return {first_leaf_, 0};
+    }
+
+    ConstIterator end() const noexcept {
+        return {nullptr, 0};
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    void swap(TreeVector& other) noexcept {
+        std::swap(root_, other.root_);
+        std::swap(first_leaf_, other.first_leaf_);
+        std::swap(last_leaf_, other.last_leaf_);
+        std::swap(size_, other.size_);
+        std::swap(height_, other.height_);
+    }
+
+private:
+    static constexpr size_t kMinLeafSize = kLeafCapacity / 4;
+    static constexpr size_t kMinInnerSize = kBranching / 4;
+
+    std::pair<Leaf*, size_t> Locate(size_t index) const noexcept {
+        Node* node = root_;
+        for (size_t level = height_; level > 0; --level) {
+            Inner* inner = static_cast<Inner*>(node);
+            size_t child = 0;
+            while (index >= inner->counts[child]) {
+                index -= inner->counts[child];
+                ++child;
+            }
+            node = inner->children[child];
+        }
+        return {static_cast<Leaf*>(node), index};
+    }
+
+    template <typename Item>
+    static void InsertIntoArray(Item* items, size_t size, size_t index, Item&& item) {
+        std::move_backward(items + index, items + size, items + size + 1);
+        items[index] = std::move(item);
+    }
+
+    template <typename Item>
+    static void EraseFromArray(Item* items, size_t size, size_t index) {
+        std::move(items + index + 1, items + size, items + index);
+    }
+
+    // Перекладывает элементы между соседними массивами a и b так, чтобы в a
+    // осталось new_a_size элементов; порядок a, b сохраняется.
+    template <typename Item>
+    static void Shift(Item* a, size_t a_size, Item* b, size_t b_size, size_t new_a_size) {
+        if (new_a_size > a_size) {
+            const size_t count = new_a_size - a_size;
+            std::move(b, b + count, a + a_size);
+            std::move(b + count, b + b_size, b);
+        }
+        else if (new_a_size < a_size) {
+            const size_t count = a_size - new_a_size;
+            std::move_backward(b, b + b_size, b + b_size + count);
+            std::move(a + new_a_size, a + a_size, b);
+        }
+    }
+
+    static size_t SumCounts(const Inner* inner) noexcept {
+        size_t sum = 0;
+        for (size_t child = 0; child < inner->size; ++child) {
+            sum += inner->counts[child];
+        }
+        return sum;
+    }
+
+    void LinkAfter(Leaf* leaf, Leaf* next) noexcept {
+        next->prev = leaf;
+        next->next = leaf->next;
+        if (leaf->next != nullptr) {
+            leaf->next->prev = next;
+        }
+        else {
+            last_leaf_ = next;
+        }
+        leaf->next = next;
+    }
+
+    void Unlink(Leaf* leaf) noexcept {
+        if (leaf->prev != nullptr) {
+            leaf->prev->next = leaf->next;
+        }
+        else {
+            first_leaf_ = leaf->next;
+        }
+        if (leaf->next != nullptr) {
+            leaf->next->prev = leaf->prev;
+        }
+        else {
+            last_leaf_ = leaf->prev;
+        }
+    }
+
+    // Возвращает правую половину, если узел пришлось разделить.
+    Node* InsertInto(Node* node, size_t level, size_t index, Type&& value, size_t& right_count) {
+        if (level == 0) {
+            return InsertIntoLeaf(static_cast<Leaf*>(node), index, std::move(value), right_count);
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        size_t child = 0;
+        while (child + 1 < inner->size && index > inner->counts[child]) {
+            index -= inner->counts[child];
+            ++child;
+        }
+        size_t child_right_count = 0;
+        Node* split = InsertInto(inner->children[child], level - 1, index, std::move(value), child_right_count);
+        ++inner->counts[child];
+        if (split == nullptr) {
+            return nullptr;
+        }
+        inner->counts[child] -= child_right_count;
+        return InsertChild(inner, child + 1, split, child_right_count, right_count);
+    }
+
+    Node* InsertIntoLeaf(Leaf* leaf, size_t index, Type&& value, size_t& right_count) {
+        if (leaf->size < kLeafCapacity) {
+            InsertIntoArray(leaf->items, leaf->size++, index, std::move(value));
+            return nullptr;
+        }
+        constexpr size_t half = kLeafCapacity / 2;
+        Leaf* right = new Leaf;
+        std::move(leaf->items + half, leaf->items + kLeafCapacity, right->items);
+        right->size = kLeafCapacity - half;
+        leaf->size = half;
+        LinkAfter(leaf, right);
+        if (index <= half) {
+            InsertIntoArray(leaf->items, leaf->size++, index, std::move(value));
+        }
+        else {
+            InsertIntoArray(right->items, right->size++, index - half, std::move(value));
+        }
+        right_count = right->size;
+        return right;
+    }
+
+    Node* InsertChild(Inner* inner, size_t position, Node* child, size_t count, size_t& right_count) {
+        if (inner->size < kBranching) {
+            InsertIntoArray(inner->children, inner->size, position, std::move(child));
+            InsertIntoArray(inner->counts, inner->size, position, std::move(count));
+            ++inner->size;
+            return nullptr;
+        }
+        constexpr size_t half = kBranching / 2;
+        Inner* right = new Inner;
+        std::move(inner->children + half, inner->children + kBranching, right->children);
+        std::move(inner->counts + half, inner->counts + kBranching, right->counts);
+        right->size = kBranching - half;
+        inner->size = half;
+        Inner* target = position <= half ? inner : right;
+        const size_t target_position = position <= half ? position : position - half;
+        InsertIntoArray(target->children, target->size, target_position, std::move(child));
+        InsertIntoArray(target->counts, target->size, target_position, std::move(count));
+        ++target->size;
+        right_count = SumCounts(right);
+        return right;
+    }
+
+    void EraseFrom(Node* node, size_t level, size_t index) {
+        if (level == 0) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            EraseFromArray(leaf->items, leaf->size--, index);
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        size_t child = 0;
+        while (index >= inner->counts[child]) {
+            index -= inner->counts[child];
+            ++child;
+        }
+        EraseFrom(inner->children[child], level - 1, index);
+        --inner->counts[child];
+        const bool underflow = level == 1 ? static_cast<Leaf*>(inner->children[child])->size < kMinLeafSize
+                                          : static_cast<Inner*>(inner->children[child])->size < kMinInnerSize;
+        if (underflow) {
+            Rebalance(inner, child, level - 1);
+        }
+    }
+
+    // Сливает недозаполненного потомка с соседом или, если вместе они не
+    // помещаются в один узел, делит их содержимое поровну.
+    void Rebalance(Inner* parent, size_t child, size_t child_level) {
+        if (parent->size < 2) {
+            return;
+        }
+        const size_t left = child > 0 ? child - 1 : 0;
+        const size_t right = left + 1;
+        if (child_level == 0) {
+            Leaf* a = static_cast<Leaf*>(parent->children[left]);
+            Leaf* b = static_cast<Leaf*>(parent->children[right]);
+            const size_t total = a->size + b->size;
+            if (total <= kLeafCapacity) {
+                Shift(a->items, a->size, b->items, b->size, total);
+                a->size = total;
+                Unlink(b);
+                delete b;
+                RemoveChild(parent, left, right);
+                return;
+            }
+            Shift(a->items, a->size, b->items, b->size, total / 2);
+            a->size = total / 2;
+            b->size = total - total / 2;
+            parent->counts[left] = a->size;
+            parent->counts[right] = b->size;
+            return;
+        }
+        Inner* a = static_cast<Inner*>(parent->children[left]);
+        Inner* b = static_cast<Inner*>(parent->children[right]);
+        const size_t total = a->size + b->size;
+        const size_t new_a_size = total <= kBranching ? total : total / 2;
+        Shift(a->children, a->size, b->children, b->size, new_a_size);
+        Shift(a->counts, a->size, b->counts, b->size, new_a_size);
+        a->size = new_a_size;
+        b->size = total - new_a_size;
+        if (b->size == 0) {
+            delete b;
+            RemoveChild(parent, left, right);
+            return;
+        }
+        parent->counts[left] = SumCounts(a);
+        parent->counts[right] = SumCounts(b);
+    }
+
+    // Переносит счётчик слитого потомка right в left и удаляет right из parent.
+    static void RemoveChild(Inner* parent, size_t left, size_t right) noexcept {
+        parent->counts[left] += parent->counts[right];
+        EraseFromArray(parent->children, parent->size, right);
+        EraseFromArray(parent->counts, parent->size, right);
+        --parent->size;
+    }
+
+    static void DeleteSubtree(Node* node, size_t level) noexcept {
+        if (level == 0) {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        for (size_t child = 0; child < inner->size; ++child) {
+            DeleteSubtree(inner->children[child], level - 1);
+        }
+        delete inner;
+    }
+
+    static void DeleteInnerNodes(Node* node, size_t level) noexcept {
+        if (level == 0) {
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        for (size_t child = 0; child < inner->size; ++child) {
+            DeleteInnerNodes(inner->children[child], level - 1);
+        }
+        delete inner;
+    }
+
+    static SimpleVector<Leaf*> CollectLeaves(Leaf* first, Leaf* stop) {
+        SimpleVector<Leaf*> leaves;
+        for (Leaf* leaf = first; leaf != stop; leaf = leaf->next) {
+            leaves.PushBack(leaf);
+        }
+        return leaves;
+    }
+
+    // Строит индексные уровни над уже связанным списком листов.
+    void AdoptLeaves(const SimpleVector<Leaf*>& leaves, size_t size) {
+        assert(!leaves.IsEmpty());
+        first_leaf_ = leaves[0];
+        last_leaf_ = leaves[leaves.GetSize() - 1];
+        size_ = size;
+        height_ = 0;
+        SimpleVector<Node*> nodes(leaves.GetSize());
+        SimpleVector<size_t> counts(leaves.GetSize());
+        for (size_t i = 0; i < leaves.GetSize(); ++i) {
+            nodes[i] = leaves[i];
+            counts[i] = leaves[i]->size;
+        }
+        while (nodes.GetSize() > 1) {
+            const size_t group_count = (nodes.GetSize() + kBranching - 1) / kBranching;
+            SimpleVector<Node*> parents(group_count);
+            SimpleVector<size_t> parent_counts(group_count);
+            for (size_t group = 0; group < group_count; ++group) {
+                const auto [begin, end] = SplitRange(nodes.GetSize(), group_count, group);
+                Inner* inner = new Inner;
+                std::copy(nodes.begin() + begin, nodes.begin() + end, inner->children);
+                std::copy(counts.begin() + begin, counts.begin() + end, inner->counts);
+                inner->size = end - begin;
+                parents[group] = inner;
+                parent_counts[group] = SumCounts(inner);
+            }
+            nodes = std::move(parents);
+            counts = std::move(parent_counts);
+            ++height_;
+        }
+        root_ = nodes[0];
+    }
+
+    template <typename InputIt>
+    void BuildFrom(InputIt first, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        SimpleVector<Leaf*> leaves;
+        Leaf* previous = nullptr;
+        for (size_t done = 0; done < size;) {
+            Leaf* leaf = new Leaf;
+            const size_t count = std::min(kLeafCapacity, size - done);
+            for (size_t i = 0; i < count; ++i, ++first) {
+                leaf->items[i] = *first;
+            }
+            leaf->size = count;
+            leaf->prev = previous;
+            if (previous != nullptr) {
+                previous->next = leaf;
+            }
+            previous = leaf;
+            leaves.PushBack(leaf);
+            done += count;
+        }
+        AdoptLeaves(leaves, size);
+    }
+
+    Node* root_ = nullptr;
+    Leaf* first_leaf_ = nullptr;
+    Leaf* last_leaf_ = nullptr;
+    size_t size_ = 0;
+    size_t height_ = 0;
+};
+
+template <typename Type>
+bool operator==(const TreeVector<Type>& lhs, const TreeVector<Type>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename Type>
+bool operator!=(const TreeVector<Type>& lhs, const TreeVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+
+#include "hash_utils.h"
+#include "radix_sort.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+enum class UniqueStrategy {
+    // Sort для целых типов, Hash для остальных.
+    Auto,
+    // Результат упорядочен по возрастанию значения.
+    Sort,
+    // Результат упорядочен по первому появлению значения.
+    Hash,
+};
+
+namespace unique_detail {
+
+template <typename Type>
+constexpr bool kRadixSortable = std::is_integral_v<Type> && !std::is_same_v<Type, bool>;
+
+template <typename Type>
+UniqueStrategy Resolve(UniqueStrategy strategy) noexcept {
+    if (strategy != UniqueStrategy::Auto) {
+        return strategy;
+    }
+    return kRadixSortable<Type> ? UniqueStrategy::Sort : UniqueStrategy::Hash;
+}
+
+// Устойчивая сортировка индексов: для целых — поразрядная, иначе stable_sort.
+template <typename Type>
+SimpleVector<size_t> StableOrder(SimpleVectorView<Type> values) {
+    if constexpr (kRadixSortable<Type>) {
+        return RadixSortIndices(values);
+    }
+    else {
+        SimpleVector<size_t> order(values.GetSize());
+        for (size_t i = 0; i < order.GetSize(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&values](size_t lhs, size_t rhs) {
+            return values[lhs] < values[rhs];
+        });
+        return order;
+    }
+}
+
+}  // namespace unique_detail
+
+// Индексы первых вхождений различных значений. Для Sort индексы
+// упорядочены по значению, для Hash — по возрастанию.
+template <typename Type>
+SimpleVector<size_t> DistinctIndices(SimpleVectorView<Type> values, UniqueStrategy strategy = UniqueStrategy::Auto) {
+    SimpleVector<size_t> result;
+    if (unique_detail::Resolve<Type>(strategy) == UniqueStrategy::Sort) {
+        const SimpleVector<size_t> order = unique_detail::StableOrder(values);
+        for (size_t i = 0; i < order.GetSize(); ++i) {
+            if (i == 0 || values[order[i - 1]] < values[order[i]]) {
+                result.PushBack(order[i]);
+            }
+        }
+    }
+    else {
+        FlatIdTable<Type> seen;
+        for (size_t i = 0; i < values.GetSize(); ++i) {
+            if (seen.FindOrInsert(values[i]) == result.GetSize()) {
+                result.PushBack(i);
+            }
+        }
+    }
+    return result;
+}
+
+template <typename Type>
+SimpleVector<size_t> DistinctIndices(const SimpleVector<Type>& values, UniqueStrategy strategy = UniqueStrategy::Auto) {
+    return DistinctIndices(SimpleVectorView<Type>(values), strategy);
+}
+
+template <typename Type>
+SimpleVector<size_t> DistinctIndices(MutableSimpleVectorView<Type> values,
+                                     UniqueStrategy strategy = UniqueStrategy::Auto) {
+    return DistinctIndices(SimpleVectorView<Type>(values), strategy);
+}
+
+// Различные значения в порядке, заданном стратегией.
+template <typename Type>
+SimpleVector<Type> Unique(SimpleVectorView<Type> values, UniqueStrategy strategy = UniqueStrategy::Auto) {
+    if (unique_detail::Resolve<Type>(strategy) == UniqueStrategy::Sort) {
+        SimpleVector<Type> result = values.ToSimpleVector();
+        if constexpr (unique_detail::kRadixSortable<Type>) {
+            RadixSort(result);
+        }
+        else {
+            std::sort(result.begin(), result.end());
+        }
+        result.Resize(static_cast<size_t>(std::unique(result.begin(), result.end()) - result.begin()));
+        return result;
+    }
+    const SimpleVector<size_t> indices = DistinctIndices(values, UniqueStrategy::Hash);
+    SimpleVector<Type> result(indices.GetSize());
+    for (size_t i = 0; i < indices.GetSize(); ++i) {
+        result[i] = values[indices[i]];
+    }
+    return result;
+}
+
+template <typename Type>
+SimpleVector<Type> Unique(const SimpleVector<Type>& values, UniqueStrategy strategy = UniqueStrategy::Auto) {
+    return Unique(SimpleVectorView<Type>(values), strategy);
+}
+
+template <typename Type>
+SimpleVector<Type> Unique(MutableSimpleVectorView<Type> values, UniqueStrategy strategy = UniqueStrategy::Auto) {
+    return Unique(SimpleVectorView<Type>(values), strategy);
+}
+
+// Оставляет на месте первые вхождения в исходном порядке за один проход
+// уплотнения. Возвращает число удалённых элементов.
+template <typename Type>
+size_t UniqueInPlace(SimpleVector<Type>& values) {
+    FlatIdTable<Type> seen;
+    return values.EraseIf([&seen](const Type& value) {
+        const size_t seen_before = seen.GetSize();
+        return seen.FindOrInsert(value) < seen_before;
+    });
+}